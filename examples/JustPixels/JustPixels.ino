@@ -23,7 +23,7 @@ using namespace EZ;
 //
 NEO::STRAND strand(PIXEL::ORDER::RGB, STRAND_LEN, NEO::TYPE::WS2812B_V1, STRAND_PIN, RMT_CHANNEL_0);
 
-// Assign strand to NEO Pixel DRIVER (maximum of 4 strands are supported)
+// Assign strand to NEO Pixel DRIVER (any number of strands, channels are shared once they run out)
 //
 NEO::DRIVER neo(strand);
 
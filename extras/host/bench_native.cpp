@@ -0,0 +1,121 @@
+/*
+** EZIoT - Host Benchmark: VAR::NUMERIC native() vs value(String)
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include <mutex>
+
+/*
+** The variable classes need the whole IOT / SERVICE stack, which doesn't build on a host,
+** so NUMERIC below follows the two set paths of VAR::NUMERIC<_T> step for step, with a
+** std::mutex for the service mutex:
+**
+** text()   - what native(nv) used to do, value(String(nv)): format, copy into value()'s
+**            by-value parameter, parse back (_deString), clamp / step check, compare.
+** native() - the typed path: clamp / step check, compare.
+*/
+template<class _T> class NUMERIC
+{
+public:
+    NUMERIC(_T minValue, _T maxValue, _T stepValue)
+        : _activeValue(0), _minValue(minValue), _maxValue(maxValue), _stepValue(stepValue)
+    {
+    }
+
+    bool text(_T nv) { return value(String(nv)); }
+
+    bool value(String newValue)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _T nv = (_T)newValue.toInt();
+
+        return _checkValue(nv) && _change(nv);
+    }
+
+    bool native(_T nv)
+    {
+        if (!_checkValue(nv))
+            return false;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        return _change(nv);
+    }
+
+    _T get(void) { return _activeValue; }
+
+protected:
+    std::mutex _mutex;
+    _T _activeValue;
+    _T _minValue;
+    _T _maxValue;
+    _T _stepValue;
+
+    bool _change(_T nv)
+    {
+        if (_activeValue == nv)
+            return false;
+
+        _activeValue = nv;
+        return true;
+    }
+
+    bool _checkValue(_T& nv)
+    {
+        if (_minValue != _maxValue)
+        {
+            if (nv < _minValue)
+                nv = _minValue;
+            if (nv > _maxValue)
+                nv = _maxValue;
+        }
+
+        return !((_stepValue != 0) && (nv % _stepValue) != 0);
+    }
+};
+
+template<class _T> static void run(const char* name, _T minValue, _T maxValue)
+{
+    static const size_t N = 200000;
+    NUMERIC<_T> a(minValue, maxValue, 0), b(minValue, maxValue, 0);
+    size_t changedA = 0, changedB = 0;
+
+    // Both paths must agree on every value, clamped or not
+    for (long v = (long)minValue - 50; v <= (long)minValue + 1000; v++)
+    {
+        bool ca = a.text((_T)v), cb = b.native((_T)v);
+
+        HOST_CHECK(ca == cb && a.get() == b.get(), "%s %ld: text %d/%ld native %d/%ld", name, v, ca, (long)a.get(), cb,
+                   (long)b.get());
+    }
+
+    double text = hostNs(N, 5, [&] {
+        for (size_t i = 0; i < N; i++)
+            changedA += a.text((_T)(minValue + (i & 1023)));
+    });
+    double native = hostNs(N, 5, [&] {
+        for (size_t i = 0; i < N; i++)
+            changedB += b.native((_T)(minValue + (i & 1023)));
+    });
+
+    HOST_CHECK(changedA == changedB, "%s: %zu vs %zu changes", name, changedA, changedB);
+    printf("%-9s value(String(nv)) %7.1f ns   native(nv) %6.1f ns   x%.1f\n", name, text, native, text / native);
+}
+
+int main()
+{
+    run<int32_t>("int32_t", -100000, 100000);
+    run<uint16_t>("uint16_t", 0, 65535);
+    run<uint8_t>("uint8_t", 0, 255);
+
+    return HOST_RESULT();
+}
@@ -0,0 +1,109 @@
+/*
+** EZIoT - Host Benchmark: VERSIONED reads under contention
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include "core/tool/ez_versioned.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace EZ;
+
+/*
+** One writer publishes continuously (serialised by a mutex, as the service mutex does),
+** while 1..4 readers read as fast as they can. Compares the lock free VERSIONED read with
+** the mutex protected read it replaced, and checks that no read is ever torn: every word
+** of a published value is the same.
+*/
+typedef struct
+{
+    uint32_t a, b, c, d;
+} value_t;
+
+static const int RUN_MS = 200;
+
+static bool consistent(const value_t& v) { return v.a == v.b && v.a == v.c && v.a == v.d; }
+
+template<class _READ> static double run(int readers, _READ read, std::mutex& mutex, VERSIONED<value_t>& shared,
+                                       value_t& guarded, uint32_t& torn)
+{
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> reads(0);
+    std::vector<std::thread> threads;
+
+    std::thread writer([&] {
+        for (uint32_t n = 1; !stop.load(std::memory_order_relaxed); n++)
+        {
+            value_t v = {n, n, n, n};
+            std::lock_guard<std::mutex> lock(mutex);
+
+            guarded = v;
+            shared.publish(v);
+        }
+    });
+
+    for (int r = 0; r < readers; r++)
+    {
+        threads.emplace_back([&] {
+            uint64_t count = 0;
+            uint32_t bad = 0;
+
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                value_t v = read();
+
+                bad += !consistent(v);
+                count++;
+            }
+
+            reads += count;
+            __atomic_add_fetch(&torn, bad, __ATOMIC_RELAXED);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(RUN_MS));
+    stop = true;
+
+    for (auto& t : threads)
+        t.join();
+    writer.join();
+
+    return (RUN_MS * 1e6 * readers) / reads.load(); // ns per read, per reader
+}
+
+int main()
+{
+    std::mutex mutex;
+    VERSIONED<value_t> shared;
+    value_t guarded = {0, 0, 0, 0};
+    uint32_t torn = 0;
+
+    shared.publish(guarded);
+
+    for (int readers = 1; readers <= 4; readers *= 2)
+    {
+        double lockFree = run(readers, [&] { return shared.read(); }, mutex, shared, guarded, torn);
+        double locked = run(readers,
+                            [&] {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                return guarded;
+                            },
+                            mutex, shared, guarded, torn);
+
+        printf("%d reader(s) + writer: VERSIONED %7.1f ns/read   mutex %8.1f ns/read\n", readers, lockFree, locked);
+    }
+
+    HOST_CHECK(!torn, "%u torn reads", torn);
+    return HOST_RESULT();
+}
@@ -0,0 +1,62 @@
+/*
+** EZIoT - Host Test Helpers
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_HOST_H
+#define _EZ_HOST_H
+#include <Arduino.h>
+#include <chrono>
+#include <cstdio>
+
+static int __hostFailures = 0;
+
+// Count and report a failed check, the program exits non-zero via HOST_RESULT()
+#define HOST_CHECK(cond, ...)                                                                                          \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            if (__hostFailures++ < 10)                                                                                 \
+            {                                                                                                          \
+                printf("FAIL %s:%d: %s - ", __FILE__, __LINE__, #cond);                                                \
+                printf(__VA_ARGS__);                                                                                   \
+                printf("\n");                                                                                          \
+            }                                                                                                          \
+        }                                                                                                              \
+    } while (0)
+
+#define HOST_RESULT() (__hostFailures ? (printf("%d check(s) failed\n", __hostFailures), 1) : (printf("OK\n"), 0))
+
+// Keep the compiler from dropping work whose result is never read
+#define HOST_KEEP(x) asm volatile("" : : "g"(&(x)) : "memory")
+
+// Nanoseconds per item of fn(), which handles items items, best of reps runs
+//
+template<class _F> double hostNs(size_t items, int reps, _F fn)
+{
+    double best = 1e300;
+
+    for (int r = 0; r < reps; r++)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        fn();
+
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        if (ns < best)
+            best = ns;
+    }
+
+    return best / items;
+}
+#endif // _EZ_HOST_H
@@ -0,0 +1,68 @@
+/*
+** EZIoT - Host Arduino Stub
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_HOST_ARDUINO_H
+#define _EZ_HOST_ARDUINO_H
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+
+/*
+** Just enough of the ESP32 Arduino core for the hardware-free headers. min/max are
+** std::min/std::max as in current cores, so mixed argument types fail here as they would
+** on the target.
+*/
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define PROGMEM
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+#define ESP_LOGE(tag, ...)
+#define ESP_LOGW(tag, ...)
+#define ESP_LOGI(tag, ...)
+#define ESP_LOGD(tag, ...)
+#define ESP_LOGV(tag, ...)
+
+typedef uint8_t byte;
+
+inline unsigned long millis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline unsigned long micros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline long random(long howbig) { return howbig ? rand() % howbig : 0; }
+inline long random(long howsmall, long howbig) { return howsmall + random(howbig - howsmall); }
+
+inline uint8_t pgm_read_byte(const void* p) { return *(const uint8_t*)p; }
+
+#include "WString.h"
+#endif // _EZ_HOST_ARDUINO_H
@@ -0,0 +1,77 @@
+/*
+** EZIoT - Host String Stub
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_HOST_WSTRING_H
+#define _EZ_HOST_WSTRING_H
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/*
+** The part of Arduino's String the host programs use. Like the real one it keeps its text
+** in a heap buffer and formats numbers with printf style conversions, so the cost of a
+** String round trip is of the same kind as on the target.
+*/
+class String
+{
+public:
+    String(const char* cstr = "") { _copy(cstr, strlen(cstr)); }
+    String(const String& str) { _copy(str._buffer, str._len); }
+    String(char c) { _copy(&c, 1); }
+    String(int value) { _format("%d", value); }
+    String(unsigned int value) { _format("%u", value); }
+    String(long value) { _format("%ld", value); }
+    String(unsigned long value) { _format("%lu", value); }
+    String(float value, unsigned char decimals = 2) { _format("%.*f", decimals, value); }
+    String(double value, unsigned char decimals = 2) { _format("%.*f", decimals, value); }
+    ~String() { free(_buffer); }
+
+    String& operator=(const String& rhs)
+    {
+        if (this != &rhs)
+        {
+            free(_buffer);
+            _copy(rhs._buffer, rhs._len);
+        }
+        return *this;
+    }
+
+    bool operator==(const String& rhs) const { return _len == rhs._len && !memcmp(_buffer, rhs._buffer, _len); }
+    bool operator!=(const String& rhs) const { return !(*this == rhs); }
+
+    const char* c_str(void) const { return _buffer; }
+    unsigned int length(void) const { return _len; }
+    long toInt(void) const { return atol(_buffer); }
+    float toFloat(void) const { return (float)atof(_buffer); }
+
+private:
+    char* _buffer;
+    unsigned int _len;
+
+    void _copy(const char* cstr, unsigned int len)
+    {
+        _buffer = (char*)malloc(len + 1);
+        memcpy(_buffer, cstr, len);
+        _buffer[len] = 0;
+        _len = len;
+    }
+
+    template<class... _A> void _format(const char* fmt, _A... args)
+    {
+        char buf[33];
+        int len = snprintf(buf, sizeof(buf), fmt, args...);
+
+        _copy(buf, len < (int)sizeof(buf) ? len : sizeof(buf) - 1);
+    }
+};
+#endif // _EZ_HOST_WSTRING_H
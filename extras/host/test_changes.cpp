@@ -0,0 +1,135 @@
+/*
+** EZIoT - Host Test: variable change tracking
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include "core/tool/ez_changes.h"
+#include <vector>
+
+using namespace EZ;
+
+/*
+** Drives CHANGES (what SERVICE tracks its variables with) through random changes, and after
+** each one checks queries from every version against a plain scan of the change versions:
+** those from before the bitmap's epoch (the full scan), at and after it (the bitmap), and
+** with the list cut short by max.
+*/
+typedef struct
+{
+    uint16_t _index;
+    uint32_t _changedVersion;
+} item_t;
+
+// Items changed after since, in index order, at most max of them
+static std::vector<item_t*> expect(std::vector<item_t>& items, uint32_t since, int max)
+{
+    std::vector<item_t*> out;
+
+    for (size_t i = 0; i < items.size() && (int)out.size() < max; i++)
+    {
+        if (items[i]._changedVersion > since)
+            out.push_back(&items[i]);
+    }
+    return out;
+}
+
+static bool check(CHANGES<item_t>& changes, std::vector<item_t>& items, uint32_t since, int max)
+{
+    std::vector<item_t*> want = expect(items, since, max);
+    std::vector<item_t*> got(items.size() + 1);
+    int count = changes.since(since, got.data(), max);
+
+    got.resize(count);
+    return got == want;
+}
+
+static void testItems(uint16_t n, int rounds)
+{
+    CHANGES<item_t> changes;
+    std::vector<item_t> items(n);
+    int resets = 0, older = 0, newer = 0, bad = 0;
+    uint32_t epoch = 0;
+
+    for (uint16_t i = 0; i < n; i++)
+    {
+        items[i]._index = 0xffff;
+        items[i]._changedVersion = 0;
+        HOST_CHECK(changes.add(&items[i]) && items[i]._index == i, "%u items: add(%u)", n, i);
+    }
+    HOST_CHECK(changes.count() == n, "%u items: count() %u", n, changes.count());
+
+    srand(n);
+    for (int r = 0; r < rounds; r++)
+    {
+        // Mostly a few hot items, now and then any of them, so the dirty set both grows and stalls
+        uint16_t i = (rand() % 4) ? rand() % (n < 3 ? n : 3) : rand() % n;
+
+        changes.change(&items[i]);
+        HOST_CHECK(items[i]._changedVersion == changes.version(), "%u items: version of a change", n);
+
+        if (changes.epoch() != epoch)
+        {
+            HOST_CHECK(changes.epoch() == changes.version() - 1, "%u items: epoch %u at version %u", n,
+                       changes.epoch(), changes.version());
+            epoch = changes.epoch();
+            resets++;
+        }
+
+        // Every version, plus one past the newest, at full length and cut short
+        for (uint32_t since = 0; since <= changes.version() + 1; since++)
+        {
+            if (since < changes.epoch())
+                older++;
+            else
+                newer++;
+
+            if (!check(changes, items, since, n) || !check(changes, items, since, 1) ||
+                !check(changes, items, since, n / 2) || !check(changes, items, since, 0))
+                bad++;
+        }
+    }
+
+    HOST_CHECK(!bad, "%u items: %d queries differ from a full scan", n, bad);
+    HOST_CHECK(n < 3 || resets, "%u items: the bitmap never restarted", n);
+    HOST_CHECK(n < 3 || older, "%u items: no queries from before the epoch", n);
+    HOST_CHECK(newer, "%u items: no queries from the epoch on", n);
+}
+
+int main()
+{
+    testItems(1, 200);
+    testItems(2, 200);
+    testItems(7, 300);
+    testItems(8, 300);
+    testItems(33, 400);
+    testItems(100, 600);
+
+    // Nothing tracked, nothing changed
+    {
+        CHANGES<item_t> none;
+        item_t* list[1];
+
+        HOST_CHECK(none.count() == 0 && none.version() == 0 && none.since(0, list, 1) == 0, "empty tracker");
+    }
+
+    // An item that couldn't be indexed still gets its version, it just isn't listed
+    {
+        CHANGES<item_t> changes;
+        item_t lost = {0xffff, 0};
+        item_t* list[1];
+
+        changes.change(&lost);
+        HOST_CHECK(lost._changedVersion == 1 && changes.since(0, list, 1) == 0, "unindexed item");
+    }
+
+    return HOST_RESULT();
+}
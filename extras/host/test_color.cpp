@@ -0,0 +1,168 @@
+/*
+** EZIoT - Host Test: fixed point color conversions
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include "core/tool/ez_color.h"
+#include <vector>
+
+using namespace EZ;
+
+/*
+** Checks the table driven integer conversions against the float ones they stand in for
+** (and against the double formulas fromHSBi() and fromTemperature() replaced), then times
+** them in ns per conversion over 4096 element batches.
+*/
+static int maxDiff(COLOR a, COLOR b)
+{
+    int m = 0;
+
+    for (int k = 0; k < 4; k++)
+        m = max(m, abs(a.q[k] - b.q[k]));
+    return m;
+}
+
+// The original HSB conversion, in double
+static COLOR hsbReference(int h, int s, int br)
+{
+    double l = br / 100.0 * 255, sf = s / 100.0;
+    int t = h < 120 ? h : (h < 240 ? h - 120 : h - 240);
+    double hp = 1 - t / 120.0, hs = t / 120.0;
+    double p = l * (hp + (1 - hp) * (1 - sf)), q = l * (hs + (1 - hs) * (1 - sf)), w = l * (1 - sf);
+    COLOR c(0U);
+
+    if (s == 0)
+        c.r = c.g = c.b = c.w = l;
+    else if (h < 120)
+        c.r = p, c.g = q, c.b = w;
+    else if (h < 240)
+        c.r = w, c.g = p, c.b = q;
+    else
+        c.r = q, c.g = w, c.b = p;
+    return c;
+}
+
+// The original black body fit (Tanner Helland), in double
+static COLOR kelvinReference(long kelvin)
+{
+    auto clamp = [](double v) { return v < 0 ? 0 : (v > 255 ? 255 : v); };
+    long t = kelvin / 100;
+    COLOR c(0U);
+
+    c.r = t <= 66 ? 255 : clamp(329.698727446 * pow(t - 60, -0.1332047592));
+    c.g = t <= 66 ? clamp(t > 0 ? 99.4708025861 * log(t) - 161.1195681661 : 0)
+                  : clamp(288.1221695283 * pow(t - 60, -0.0755148492));
+    c.b = t >= 66 ? 255 : (t <= 19 ? 0 : clamp(138.5177312231 * log(t - 10) - 305.0447927307));
+    return c;
+}
+
+static void checkAccuracy(void)
+{
+    int hsi = 0, hsiw = 0, hsb = 0, kelvin = 0, xyb = 0;
+    COLOR a, b;
+
+    for (int h = 0; h < 360; h++)
+    {
+        for (int s = 0; s < 256; s++)
+        {
+            for (int i = 0; i < 256; i += 5)
+            {
+                a.fromHSIf(h, s / 255.0f, i / 255.0f);
+                b.fromHSIi(h, s, i);
+                hsi = max(hsi, maxDiff(a, b));
+
+                a.fromHSIf2RGBW(h, s / 255.0f, i / 255.0f);
+                b.fromHSIi2RGBW(h, s, i);
+                hsiw = max(hsiw, maxDiff(a, b));
+            }
+        }
+    }
+
+    for (int h = 0; h <= 360; h++)
+    {
+        for (int s = 0; s <= 100; s++)
+        {
+            for (int br = 0; br <= 100; br++)
+                hsb = max(hsb, maxDiff(hsbReference(h, s, br), b.fromHSBi(h, s, br)));
+        }
+    }
+
+    // Above ~31500 K the old code wrapped its uint8_t intermediate, the table holds the intended values
+    for (long k = 0; k <= 31500; k += 7)
+        kelvin = max(kelvin, maxDiff(kelvinReference(k), b.fromTemperature(k)));
+
+    for (int xi = 1; xi < 800; xi += 3)
+    {
+        for (int yi = 1; yi < 900 && xi + yi <= 1000; yi += 3)
+        {
+            for (int br = 1; br <= 250; br += 13)
+            {
+                float x = xi / 1000.0f, y = yi / 1000.0f;
+                int d;
+
+                a.fromXYB(x, y, br);
+                b.fromXYBi((uint16_t)(x * 65536 + 0.5f), (uint16_t)(y * 65536 + 0.5f), br);
+
+                // The float version casts results above 1.0 straight to uint8_t and wraps
+                if ((d = maxDiff(a, b)) < 100)
+                    xyb = max(xyb, d);
+            }
+        }
+    }
+
+    printf("Max channel error: HSI %d, HSI2RGBW %d, HSB %d, XYB %d, Temperature %d\n", hsi, hsiw, hsb, xyb, kelvin);
+    HOST_CHECK(hsi <= 1 && hsiw <= 1 && hsb <= 1 && xyb <= 1, "more than 1 LSB from the float versions");
+    HOST_CHECK(kelvin == 0, "Temperature differs from the fit by %d", kelvin);
+}
+
+int main()
+{
+    checkAccuracy();
+
+    const size_t n = 4096;
+    const int reps = 200;
+    std::vector<COLOR> out(n);
+    std::vector<uint16_t> hue(n), kelvin(n), xs(n), ys(n);
+    std::vector<float> fx(n), fy(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        hue[i] = (i * 7) % 360;
+        kelvin[i] = 1000 + (i * 13) % 9000;
+        xs[i] = 13000 + (i * 31) % 20000;
+        ys[i] = 13000 + (i * 17) % 20000;
+        fx[i] = xs[i] / 65536.0f;
+        fy[i] = ys[i] / 65536.0f;
+    }
+
+#define TIME(fn)                                                                                                       \
+    hostNs(n, reps, [&] {                                                                                              \
+        fn;                                                                                                            \
+        HOST_KEEP(out[0]);                                                                                             \
+    })
+
+    printf("ns/conversion   float  fixed\n");
+    printf("  HSI        %8.2f %6.2f\n", TIME(for (size_t i = 0; i < n; i++) out[i].fromHSIf(hue[i], 0.8f, 0.7f)),
+           TIME(COLOR::fromHSIi(out.data(), hue.data(), n, 204, 178)));
+    printf("  HSI2RGBW   %8.2f %6.2f\n",
+           TIME(for (size_t i = 0; i < n; i++) out[i].fromHSIf2RGBW(hue[i], 0.8f, 0.7f)),
+           TIME(COLOR::fromHSIi2RGBW(out.data(), hue.data(), n, 204, 178)));
+    printf("  HSB        %8.2f %6.2f\n", TIME(for (size_t i = 0; i < n; i++) out[i] = hsbReference(hue[i], 80, 70)),
+           TIME(COLOR::fromHSBi(out.data(), hue.data(), n, 80, 70)));
+    printf("  XYB        %8.2f %6.2f\n", TIME(for (size_t i = 0; i < n; i++) out[i].fromXYB(fx[i], fy[i], 200)),
+           TIME(COLOR::fromXYBi(out.data(), xs.data(), ys.data(), n, 200)));
+    printf("  Temperature%8.2f %6.2f\n", TIME(for (size_t i = 0; i < n; i++) out[i] = kelvinReference(kelvin[i])),
+           TIME(COLOR::fromTemperature(out.data(), kelvin.data(), n)));
+#undef TIME
+
+    return HOST_RESULT();
+}
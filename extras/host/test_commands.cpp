@@ -0,0 +1,174 @@
+/*
+** EZIoT - Host Test: pixel COMMANDS queue
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include "core/tool/ez_color.h"
+#include <atomic>
+#include <thread>
+
+/*
+** A HANDLER that only records what it's told, standing in for pixel_handler.h so the test
+** is just the queue. Only the render (consumer) thread touches it, as on the target.
+*/
+#define _EZ_PIXEL_HANDLER_H
+#define EZ_PIXEL_OPTION_NONE (uint8_t)0x00
+
+namespace EZ
+{
+    namespace PIXEL
+    {
+        class HANDLER
+        {
+        public:
+            HANDLER() : mode(0), options(0), speed(0), level(0), triggers(0) {}
+
+            void setMode(uint8_t m, uint8_t o)
+            {
+                mode = m;
+                options = o;
+            }
+            void setColor(uint8_t n, COLOR c) { colors[n & 3] = c; }
+            void setSpeed(uint16_t s) { speed = s; }
+            void setLevel(uint8_t l) { level = l; }
+            void setOptions(uint8_t o) { options = o; }
+            void trigger(void) { triggers++; }
+
+            uint8_t mode;
+            uint8_t options;
+            uint16_t speed;
+            uint8_t level;
+            uint32_t triggers;
+            COLOR colors[4];
+        };
+    } // namespace PIXEL
+} // namespace EZ
+
+#include "core/hal/pixel/pixel_commands.h"
+
+using namespace EZ;
+using namespace EZ::PIXEL;
+
+/*
+** Single threaded: a full queue refuses pushes, a held batch is invisible until released
+** (and only on the outermost release), and the queue is usable again once applied.
+*/
+static void checkSingle(void)
+{
+    HANDLER h;
+    COMMANDS q(10); // Rounded up to 16
+    uint16_t queued = 0;
+
+    HOST_CHECK(q.room() == 16, "room %u", q.room());
+
+    while (q.trigger(h))
+        queued++;
+
+    HOST_CHECK(queued == 16 && q.room() == 0, "queued %u room %u", queued, q.room());
+    HOST_CHECK(!q.setLevel(h, 9), "push to a full queue");
+    HOST_CHECK(q.apply() == 16 && h.triggers == 16 && q.empty(), "triggers %u", h.triggers);
+    HOST_CHECK(h.level == 0, "refused push was applied");
+
+    q.hold();
+    q.setSpeed(h, 100);
+    q.hold();
+    q.setColor(h, 1, COLOR(1, 2, 3, 0));
+    q.release();
+    HOST_CHECK(q.apply() == 0 && h.speed == 0, "inner release published the batch");
+    q.setMode(h, 7, 2);
+    q.release();
+    HOST_CHECK(q.apply() == 3 && h.speed == 100 && h.colors[1].g == 2 && h.mode == 7 && h.options == 2,
+               "batch applied as speed %u mode %u", h.speed, h.mode);
+
+    // A held batch that overflows keeps what fit, apply() then sees all of it at once
+    q.hold();
+    queued = 0;
+    while (q.setLevel(h, queued + 1))
+        queued++;
+    HOST_CHECK(queued == 16 && q.apply() == 0, "held %u", queued);
+    q.release();
+    HOST_CHECK(q.apply() == 16 && h.level == 16, "level %u", h.level);
+}
+
+/*
+** Producer and consumer threads: batches of speed + color (the color's red is the speed's
+** low byte) must never be seen half applied or out of order, and every accepted push must
+** be applied exactly once, including the bursts of triggers pushed until the queue is full.
+*/
+static void checkThreaded(uint32_t batches)
+{
+    HANDLER h;
+    COMMANDS q(16);
+    std::atomic<bool> done(false);
+    uint32_t accepted = 0, refused = 0;
+
+    std::thread producer([&] {
+        for (uint32_t i = 1; i <= batches; i++)
+        {
+            uint16_t v = (i % 60000) + 1;
+
+            // Room first, so a batch is never left half queued
+            while (q.room() < 2)
+                std::this_thread::yield();
+
+            q.hold();
+            q.setSpeed(h, v);
+            q.setColor(h, 1, COLOR((uint8_t)v, 0, 0, 0));
+            q.release();
+
+            // Now and then, fill the queue while the consumer drains it
+            if (!(i % 64))
+            {
+                while (q.room() < 8)
+                    std::this_thread::yield();
+                while (q.trigger(h))
+                    accepted++;
+                refused++;
+            }
+        }
+
+        done = true;
+    });
+
+    uint32_t applied = 0, torn = 0, backwards = 0;
+    uint16_t last = 0;
+
+    while (!done || !q.empty())
+    {
+        uint16_t n = q.apply();
+
+        applied += n;
+        if (!n)
+            std::this_thread::yield();
+
+        if ((uint8_t)h.speed != h.colors[1].r)
+            torn++;
+        if (h.speed < last && !(last > 59000 && h.speed < 1000))
+            backwards++;
+        last = h.speed;
+    }
+
+    producer.join();
+
+    printf("%u batches, %u triggers accepted, %u bursts hit a full queue\n", batches, accepted, refused);
+    HOST_CHECK(!torn && !backwards, "%u torn, %u out of order", torn, backwards);
+    HOST_CHECK(h.triggers == accepted, "%u of %u triggers applied", h.triggers, accepted);
+    HOST_CHECK(applied == batches * 2 + accepted, "%u of %u applied", applied, batches * 2 + accepted);
+}
+
+int main(int argc, char* argv[])
+{
+    checkSingle();
+    checkThreaded(argc > 1 ? atoi(argv[1]) : 100000);
+
+    return HOST_RESULT();
+}
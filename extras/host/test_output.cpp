@@ -0,0 +1,179 @@
+/*
+** EZIoT - Host Test: pixel output stage
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include "core/hal/pixel/pixel_segment.h"
+
+using namespace EZ;
+using namespace EZ::PIXEL;
+
+/*
+** Checks HANDLER::output() against a per pixel reference: level then (optional) gamma, then
+** color order or mono packing. Pixels are output at the level of the handler or segment that
+** last wrote them, so a parent's effect isn't rescaled by a segment it runs under.
+*/
+static const uint16_t PIXELS = 12;
+
+// Wire value of one channel, setPixelLevel(level) with gamma as given
+static uint8_t channel(uint8_t c, uint8_t level, bool gamma)
+{
+    uint8_t scale = level + 1;
+
+    if (scale)
+        c = (c * scale) >> 8;
+    return gamma ? gamma8(c) : c;
+}
+
+static COLOR expect(COLOR c, uint8_t level, bool gamma)
+{
+    return COLOR(channel(c.r, level, gamma), channel(c.g, level, gamma), channel(c.b, level, gamma),
+                 channel(c.w, level, gamma));
+}
+
+static COLOR pattern(uint16_t n) { return COLOR(40 + n * 17, 250 - n * 13, 7 + n * 21, 128 + n * 9); }
+
+// GRB, 3 bytes per pixel
+static bool grbAt(const uint8_t* wire, uint16_t n, COLOR c)
+{
+    const uint8_t* p = &wire[n * 3];
+    return p[0] == c.g && p[1] == c.r && p[2] == c.b;
+}
+
+static void testOrder(void)
+{
+    HANDLER grb(ORDER::GRB, PIXELS), rgbw(ORDER::RGBW, PIXELS), mono(ORDER::MONO, PIXELS);
+
+    for (uint16_t n = 0; n < PIXELS; n++)
+    {
+        grb.setPixel(n, pattern(n));
+        rgbw.setPixel(n, pattern(n));
+        mono.setPixel(n, pattern(n));
+    }
+
+    for (int level = 0; level < 256; level += 51)
+    {
+        for (int gamma = 0; gamma < 2; gamma++)
+        {
+            grb.setPixelLevel(level);
+            rgbw.setPixelLevel(level);
+            mono.setPixelLevel(level);
+            grb.setGamma(gamma);
+            rgbw.setGamma(gamma);
+            mono.setGamma(gamma);
+
+            const uint8_t* g = grb.output();
+            const uint8_t* w = rgbw.output();
+            const uint8_t* m = mono.output();
+
+            for (uint16_t n = 0; n < PIXELS; n++)
+            {
+                COLOR c = expect(pattern(n), level, gamma);
+
+                HOST_CHECK(grbAt(g, n, c), "GRB pixel %u, level %d, gamma %d", n, level, gamma);
+                HOST_CHECK(w[n * 4] == c.r && w[n * 4 + 1] == c.g && w[n * 4 + 2] == c.b && w[n * 4 + 3] == c.w,
+                           "RGBW pixel %u, level %d, gamma %d", n, level, gamma);
+                HOST_CHECK(m[n] == c.getGrey(COLOR::GREY_MODE::LUMINANCE), "MONO pixel %u, level %d, gamma %d", n,
+                           level, gamma);
+            }
+
+            // The logical pixels are never touched by output
+            HOST_CHECK(grb.getPixel(5) == pattern(5), "getPixel() changed, level %d", level);
+        }
+    }
+
+    // Gamma is opt in
+    HANDLER plain(ORDER::GRB, 1);
+
+    plain.setPixel(0, COLOR(100, 100, 100, 0));
+    HOST_CHECK(!plain.getGamma() && grbAt(plain.output(), 0, COLOR(100, 100, 100, 0)), "gamma on by default");
+}
+
+static void testSegments(void)
+{
+    const uint8_t LEVEL = 99, SEGLEVEL = 199;
+    const COLOR A(200, 100, 50, 0), B(10, 220, 130, 0), C(90, 90, 250, 0);
+    HANDLER h(ORDER::GRB, PIXELS);
+
+    h.setPixelLevel(LEVEL);
+    h.fill(A);
+
+    {
+        SEGMENT seg(h, 4, 4);
+        const uint8_t* wire;
+
+        seg.setPixelLevel(SEGLEVEL);
+        seg.setGamma(true);
+
+        // The segment claimed its (cleared) range, the rest is the parent's
+        wire = h.output();
+        for (uint16_t n = 0; n < PIXELS; n++)
+        {
+            COLOR c = (n >= 4 && n < 8) ? COLOR(0, 0, 0, 0) : expect(A, LEVEL, false);
+            HOST_CHECK(grbAt(wire, n, c), "after SEGMENT(), pixel %u", n);
+        }
+
+        // The parent's effect over the whole strand is output at the parent's level
+        h.fill(A);
+        wire = h.output();
+        for (uint16_t n = 0; n < PIXELS; n++)
+            HOST_CHECK(grbAt(wire, n, expect(A, LEVEL, false)), "parent fill, pixel %u", n);
+
+        // What the segment writes is output at its level and gamma, wherever the parent wrote last
+        seg.setPixel(1, B);
+        h.setPixel(6, C);
+        wire = h.output();
+        HOST_CHECK(grbAt(wire, 5, expect(B, SEGLEVEL, true)), "segment pixel");
+        HOST_CHECK(grbAt(wire, 6, expect(C, LEVEL, false)), "parent pixel in segment range");
+        HOST_CHECK(grbAt(wire, 4, expect(A, LEVEL, false)), "parent pixel kept");
+
+        // A nested segment, and a second segment, each own what they write
+        {
+            SEGMENT inner(seg, 2, 2), other(h, 9, 2);
+
+            inner.setPixelLevel(49);
+            other.setPixelLevel(149);
+            inner.fill(B);
+            other.setPixel(0, C);
+            seg.setPixel(0, C);
+
+            wire = h.output();
+            HOST_CHECK(grbAt(wire, 4, expect(C, SEGLEVEL, true)), "outer segment pixel");
+            HOST_CHECK(grbAt(wire, 6, expect(B, 49, false)) && grbAt(wire, 7, expect(B, 49, false)),
+                       "nested segment pixels");
+            HOST_CHECK(grbAt(wire, 9, expect(C, 149, false)), "second segment pixel");
+            HOST_CHECK(grbAt(wire, 11, expect(A, LEVEL, false)), "parent pixel beside second segment");
+        }
+
+        // The nested segment's pixels went back to its parent segment
+        wire = h.output();
+        HOST_CHECK(grbAt(wire, 6, expect(B, SEGLEVEL, true)), "pixel after nested ~SEGMENT()");
+        HOST_CHECK(grbAt(wire, 9, expect(C, LEVEL, false)), "pixel after second ~SEGMENT()");
+
+        // A level change applies to everything the handler owns at once
+        h.setPixelLevel(29);
+        wire = h.output();
+        HOST_CHECK(grbAt(wire, 0, expect(A, 29, false)), "parent level change");
+        HOST_CHECK(grbAt(wire, 5, expect(B, SEGLEVEL, true)), "segment pixel after parent level change");
+    }
+
+    // Once the segment is gone its pixels are the parent's
+    const uint8_t* wire = h.output();
+    HOST_CHECK(grbAt(wire, 5, expect(B, 29, false)), "pixel after ~SEGMENT()");
+}
+
+int main()
+{
+    testOrder();
+    testSegments();
+    return HOST_RESULT();
+}
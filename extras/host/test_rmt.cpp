@@ -0,0 +1,95 @@
+/*
+** EZIoT - Host Test: RMT symbol encoder
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include "core/hal/pixel/pixel_rmt.h"
+#include <cstring>
+#include <vector>
+
+using namespace EZ;
+
+/*
+** Checks the nibble table encoder symbol for symbol against the shift and test per bit
+** loop it replaced in __rmtCopyBlock(), over every byte value and a range of lengths, then
+** times the two.
+*/
+// Two rmt_item32_t words, level 1 then 0, durations as for a WS2812 at DIVIDER 4
+static const uint32_t ZERO = 0x00108007;
+static const uint32_t ONE = 0x000C800E;
+
+static void bitLoop(volatile uint32_t* dst, const uint8_t* src, size_t len, const uint32_t pulse[2])
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        uint16_t byteval = src[i];
+
+        for (int j = 0; j < 8; j++, byteval <<= 1)
+        {
+            int bitval = (byteval >> 7) & 0x01;
+
+            dst[i * 8 + j] = pulse[bitval];
+        }
+    }
+}
+
+int main()
+{
+    const uint32_t pulse[2] = {ZERO, ONE};
+    PIXEL::rmt_table_t table;
+    std::vector<uint8_t> data(1024);
+
+    PIXEL::rmtTable(table, ZERO, ONE);
+
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i < 256 ? i : random(256);
+
+    // Every byte value, then odd lengths and offsets, with a guard symbol past the end
+    //
+    const size_t lengths[] = {0, 1, 3, 4, 7, 256, 1023};
+
+    for (size_t len : lengths)
+    {
+        for (size_t offset = 0; offset + len <= data.size() && offset < 3; offset++)
+        {
+            std::vector<uint32_t> want(len * 8 + 1, 0xDEADBEEF), got(len * 8 + 1, 0xDEADBEEF);
+
+            bitLoop(want.data(), &data[offset], len, pulse);
+            PIXEL::rmtEncode(got.data(), &data[offset], len, table);
+
+            HOST_CHECK(memcmp(want.data(), got.data(), want.size() * sizeof(uint32_t)) == 0,
+                       "len %zu offset %zu differs", len, offset);
+        }
+    }
+
+    // 32 symbols (4 bytes) is one half block refill on target, time a whole strand's worth
+    //
+    const size_t bytes = 300 * 3;
+    std::vector<uint8_t> frame(bytes);
+    std::vector<uint32_t> mem(bytes * 8);
+
+    for (auto& b : frame)
+        b = random(256);
+
+    double loop = hostNs(bytes, 200, [&] {
+        bitLoop(mem.data(), frame.data(), bytes, pulse);
+        HOST_KEEP(mem[0]);
+    });
+    double lut = hostNs(bytes, 200, [&] {
+        PIXEL::rmtEncode(mem.data(), frame.data(), bytes, table);
+        HOST_KEEP(mem[0]);
+    });
+
+    printf("RMT encode: bit loop %6.2f ns/byte   nibble table %6.2f ns/byte\n", loop, lut);
+
+    return HOST_RESULT();
+}
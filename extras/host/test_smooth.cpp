@@ -0,0 +1,203 @@
+/*
+** EZIoT - Host Test: signal smoothing
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include "core/hal/hal_smooth.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <vector>
+
+using namespace EZ::HAL;
+
+/*
+** Feeds SMOOTH, AVERAGE, EMA and MEDIAN a noisy signal with spikes, from the first sample on
+** (a part filled window included), and checks each against a plain reference: the mean or
+** median of the last N samples, or an exponential average in double precision.
+*/
+static const int SAMPLES = 5000;
+
+// A ramp and a sine, with noise and the odd spike, over the type's range
+template<class _T> static std::vector<_T> signal(double lo, double hi)
+{
+    std::vector<_T> out;
+
+    srand(7);
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        double mid = (lo + hi) / 2, span = (hi - lo) / 2;
+        double v = mid + span * 0.6 * sin(i / 40.0) + span * 0.2 * ((i % 500) / 500.0) +
+                   span * 0.1 * (rand() / (double)RAND_MAX - 0.5);
+
+        if (rand() % 50 == 0)
+            v = (rand() & 1) ? hi : lo;
+        out.push_back((_T)std::max(lo, std::min(hi, v)));
+    }
+
+    return out;
+}
+
+// Mean of the last (up to) n samples, truncated as an integer average is
+template<class _T, class _S> static _T mean(const std::deque<_T>& last)
+{
+    _S sum = 0;
+
+    for (_T v : last)
+        sum += v;
+    return (_T)(sum / (_S)last.size());
+}
+
+template<class _T> static _T median(const std::deque<_T>& last)
+{
+    std::vector<_T> sorted(last.begin(), last.end());
+
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size() / 2];
+}
+
+template<class _T, uint16_t _N> static void testAverage(const char* name, const std::vector<_T>& in)
+{
+    AVERAGE<_T, _N> avg;
+    SMOOTH<_T> smooth(_N);
+    std::deque<_T> last;
+    int bad = 0;
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        last.push_back(in[i]);
+        if (last.size() > _N)
+            last.pop_front();
+
+        _T expect = mean<_T, ACCUMULATOR<_T>>(last);
+        _T a = avg.smooth(in[i]), s = smooth.smooth(in[i]);
+
+        if (std::is_integral<_T>::value ? (a != expect || s != expect)
+                                        : (fabs((double)a - expect) > 1e-3 * (1 + fabs((double)expect)) ||
+                                           fabs((double)s - expect) > 1e-3 * (1 + fabs((double)expect))))
+            bad++;
+    }
+
+    HOST_CHECK(!bad, "%s: %d samples off the mean", name, bad);
+
+    avg.reset();
+    HOST_CHECK(avg.value() == 0 && avg.smooth(in[0]) == in[0], "%s: reset()", name);
+}
+
+template<class _T, uint8_t _N> static void testMedian(const char* name, const std::vector<_T>& in)
+{
+    MEDIAN<_T, _N> med;
+    std::deque<_T> last;
+    int bad = 0;
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        last.push_back(in[i]);
+        if (last.size() > _N)
+            last.pop_front();
+
+        if (med.smooth(in[i]) != median(last))
+            bad++;
+    }
+
+    HOST_CHECK(!bad, "%s: %d samples off the median", name, bad);
+}
+
+// The integer EMA keeps 2^_SHIFT of resolution, so tracks the exact one to within a count
+template<class _T, uint8_t _SHIFT> static void testEMA(const char* name, const std::vector<_T>& in, double within)
+{
+    EMA<_T, _SHIFT> ema;
+    double ref = in[0];
+    double worst = 0;
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        if (i)
+            ref += (in[i] - ref) / (1 << _SHIFT);
+
+        double err = fabs((double)ema.smooth(in[i]) - ref);
+
+        if (err > worst)
+            worst = err;
+    }
+
+    HOST_CHECK(worst <= within, "%s: %.3f from the exact EMA", name, worst);
+
+    ema.reset();
+    HOST_CHECK(ema.smooth(in[1]) == in[1], "%s: reset() re-primes", name);
+}
+
+int main()
+{
+    std::vector<uint16_t> u16 = signal<uint16_t>(0, 65535);
+    std::vector<int16_t> i16 = signal<int16_t>(-32768, 32767);
+    std::vector<int32_t> i32 = signal<int32_t>(-2147483648.0, 2147483647.0);
+    std::vector<uint32_t> u32 = signal<uint32_t>(0, 4294967295.0);
+    std::vector<float> f32 = signal<float>(-100, 100);
+
+    testAverage<uint16_t, 1>("AVERAGE<uint16_t, 1>", u16);
+    testAverage<uint16_t, 16>("AVERAGE<uint16_t, 16>", u16);
+    testAverage<int16_t, 100>("AVERAGE<int16_t, 100>", i16);
+    testAverage<int32_t, 10>("AVERAGE<int32_t, 10>", i32);
+    testAverage<uint32_t, 64>("AVERAGE<uint32_t, 64>", u32);
+    testAverage<float, 20>("AVERAGE<float, 20>", f32);
+
+    // Windows at the accumulator's limit still don't overflow
+    {
+        AVERAGE<uint16_t, 32768> full;
+        AVERAGE<uint32_t, 65535> wide;
+        uint16_t a = 0;
+        uint32_t b = 0;
+
+        for (uint32_t i = 0; i < 70000; i++)
+        {
+            a = full.smooth(65535);
+            b = wide.smooth(4294967295UL);
+        }
+        HOST_CHECK(a == 65535 && b == 4294967295UL, "full windows average %u, %u", a, b);
+    }
+
+    // SMOOTH clamps its window to 1..100, a window of 1 passes samples straight through
+    {
+        SMOOTH<int16_t> one(0), most(500);
+
+        HOST_CHECK(one.smooth(123) == 123 && one.smooth(-7) == -7, "SMOOTH(0) passes through");
+        for (int i = 0; i < 100; i++)
+            most.smooth(0);
+        for (int i = 0; i < 100; i++)
+            most.smooth(100);
+        HOST_CHECK(most.smooth(200) == 101, "SMOOTH(500) holds 100 samples");
+    }
+
+    testMedian<uint16_t, 1>("MEDIAN<uint16_t, 1>", u16);
+    testMedian<uint16_t, 5>("MEDIAN<uint16_t, 5>", u16);
+    testMedian<int16_t, 9>("MEDIAN<int16_t, 9>", i16);
+    testMedian<int32_t, 31>("MEDIAN<int32_t, 31>", i32);
+    testMedian<float, 7>("MEDIAN<float, 7>", f32);
+
+    // A single spike never gets through a median of 3 or more
+    {
+        MEDIAN<int16_t, 3> med;
+        int16_t worst = 0;
+
+        for (int i = 0; i < 100; i++)
+            worst = std::max(worst, med.smooth(i % 10 == 5 ? 30000 : 10));
+        HOST_CHECK(worst == 10, "MEDIAN<3> let a spike through (%d)", worst);
+    }
+
+    testEMA<uint16_t, 3>("EMA<uint16_t, 3>", u16, 1.5);
+    testEMA<int16_t, 4>("EMA<int16_t, 4>", i16, 1.5);
+    testEMA<int32_t, 8>("EMA<int32_t, 8>", i32, 1.5);
+    testEMA<float, 5>("EMA<float, 5>", f32, 1e-3);
+
+    return HOST_RESULT();
+}
@@ -0,0 +1,154 @@
+/*
+** EZIoT - Host Test: parallel output bit-plane transposition
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include "core/hal/pixel/pixel_transpose.h"
+#include <vector>
+
+using namespace EZ;
+
+/*
+** Checks transpose16() and encodeParallel() against a bit at a time reference: lanes
+** shorter than the frame padded with 0, lanes outside the mask never driven, and samples
+** stored in swapped pairs (out[i ^ 1]). Then times the two.
+*/
+static size_t reference(uint16_t* out, const uint8_t* const data[], const size_t count[], uint8_t lanes, size_t len,
+                        uint16_t mask)
+{
+    size_t i = 0;
+
+    for (size_t b = 0; b < len; b++)
+    {
+        for (int k = 0; k < 8; k++)
+        {
+            uint16_t bits = 0;
+
+            for (uint8_t n = 0; n < lanes; n++)
+            {
+                if (b < count[n] && (data[n][b] & (0x80 >> k)))
+                    bits |= 1 << n;
+            }
+
+            out[i++ ^ 1] = mask;
+            out[i++ ^ 1] = bits & mask;
+            out[i++ ^ 1] = 0;
+        }
+    }
+
+    return i;
+}
+
+static void checkTranspose16(void)
+{
+    for (int r = 0; r < 1000; r++)
+    {
+        uint8_t lane[PIXEL::MAX_LANES];
+        uint16_t plane[8];
+
+        for (auto& b : lane)
+            b = random(256);
+
+        PIXEL::transpose16(lane, plane);
+
+        for (int k = 0; k < 8; k++)
+        {
+            for (int n = 0; n < PIXEL::MAX_LANES; n++)
+            {
+                bool want = lane[n] & (0x80 >> k), got = plane[k] & (1 << n);
+
+                HOST_CHECK(want == got, "transpose16 plane %d lane %d", k, n);
+            }
+        }
+    }
+}
+
+static void checkEncode(uint8_t lanes, uint16_t mask, const std::vector<std::vector<uint8_t>>& strands, size_t len)
+{
+    const uint8_t* data[PIXEL::MAX_LANES];
+    size_t count[PIXEL::MAX_LANES];
+
+    for (uint8_t n = 0; n < lanes; n++)
+    {
+        data[n] = strands[n].data();
+        count[n] = strands[n].size();
+    }
+
+    // One sample pair past the end catches an overrun
+    std::vector<uint16_t> want(len * 24 + 2, 0xA5A5), got(len * 24 + 2, 0xA5A5);
+    size_t wantN = reference(want.data(), data, count, lanes, len, mask);
+    size_t gotN = PIXEL::encodeParallel(got.data(), data, count, lanes, len, mask);
+
+    HOST_CHECK(wantN == gotN && gotN == len * 24, "%zu samples, expected %zu", gotN, wantN);
+    HOST_CHECK(want == got, "lanes %u mask %04X len %zu differs", lanes, mask, len);
+}
+
+int main()
+{
+    checkTranspose16();
+
+    // Lanes of different lengths (some empty), so the tail of the frame is zero padded
+    //
+    std::vector<std::vector<uint8_t>> strands(PIXEL::MAX_LANES);
+
+    for (int n = 0; n < PIXEL::MAX_LANES; n++)
+    {
+        strands[n].resize((n * 37) % 120);
+
+        for (auto& b : strands[n])
+            b = random(256);
+    }
+
+    const uint8_t lanes[] = {1, 3, 8, 9, 16};
+    const uint16_t masks[] = {0xFFFF, 0x0001, 0x5A5A, 0x8000, 0x0000};
+
+    for (uint8_t l : lanes)
+    {
+        for (uint16_t m : masks)
+        {
+            checkEncode(l, m, strands, 120);
+            checkEncode(l, m, strands, 1);
+        }
+    }
+
+    // 16 strands of 300 RGB pixels
+    //
+    const size_t bytes = 300 * 3;
+    const uint8_t* data[PIXEL::MAX_LANES];
+    size_t count[PIXEL::MAX_LANES];
+
+    for (int n = 0; n < PIXEL::MAX_LANES; n++)
+    {
+        strands[n].resize(bytes);
+
+        for (auto& b : strands[n])
+            b = random(256);
+
+        data[n] = strands[n].data();
+        count[n] = bytes;
+    }
+
+    std::vector<uint16_t> out(bytes * 24);
+
+    double ref = hostNs(bytes, 50, [&] {
+        reference(out.data(), data, count, PIXEL::MAX_LANES, bytes, 0xFFFF);
+        HOST_KEEP(out[0]);
+    });
+    double fast = hostNs(bytes, 50, [&] {
+        PIXEL::encodeParallel(out.data(), data, count, PIXEL::MAX_LANES, bytes, 0xFFFF);
+        HOST_KEEP(out[0]);
+    });
+
+    printf("16 lane encode: per bit %7.2f ns/byte   transposed %7.2f ns/byte\n", ref, fast);
+
+    return HOST_RESULT();
+}
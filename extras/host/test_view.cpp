@@ -0,0 +1,120 @@
+/*
+** EZIoT - Host Test: pixel VIEW segments
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "host.h"
+#include "core/hal/pixel/pixel_segment.h"
+#include <thread>
+
+using namespace EZ;
+using namespace EZ::PIXEL;
+
+/*
+** Reports the HANDLER, SEGMENT and VIEW footprints, then runs views with a custom and a
+** built-in effect over a live handler: each view only touches its own (clipped) range,
+** keeps its own effect state, and leaves the handler's mode and frame count as they were.
+*/
+typedef struct
+{
+    uint16_t frames;
+    uint16_t pixels;
+} mark_t;
+
+// Paints the range with its own frame count, so each view's state shows in its pixels
+static uint16_t mark(HANDLER& p, mark_t& s)
+{
+    s.frames++;
+    s.pixels = p.pixels();
+    p.fill(COLOR(s.frames, s.pixels, 0, 0));
+    return EZ_PIXEL_SPEED_MIN;
+}
+
+typedef struct
+{
+    uint8_t unused;
+} hold_t;
+
+// Leaves the pixels alone, so anything that changes was written by a view
+static uint16_t hold(HANDLER&, hold_t&) { return 1000; }
+
+static const uint16_t PIXELS = 20;
+static const COLOR SENTINEL(1, 2, 3, 0);
+
+int main()
+{
+    printf("sizeof HANDLER %zu, SEGMENT %zu, VIEW %zu bytes\n", sizeof(HANDLER), sizeof(SEGMENT), sizeof(VIEW));
+    HOST_CHECK(sizeof(VIEW) <= 32, "VIEW is %zu bytes", sizeof(VIEW));
+
+    HOST_CHECK(HANDLER::registerEffect(CUSTOM_FX1, effect<mark_t, mark>(F("Mark"))), "register Mark");
+    HOST_CHECK(HANDLER::registerEffect(CUSTOM_FX2, effect<hold_t, hold>(F("Hold"))), "register Hold");
+
+    HANDLER h(ORDER::GRB, PIXELS);
+
+    h.setMode(CUSTOM_FX2);
+    h.trigger();
+    h.service();
+    h.fill(SENTINEL);
+
+    uint32_t handlerFrames = h.frames();
+
+    // v2 runs off the end of the strand and is clipped, v4 starts past it and never runs
+    VIEW v1(2, 4, CUSTOM_FX1), v2(14, 100, CUSTOM_FX1), v3(8, 3, 39), v4(PIXELS, 5, CUSTOM_FX1);
+    uint16_t runs1 = 0, runs2 = 0, runs4 = 0;
+
+    for (int i = 0; i < 20; i++)
+    {
+        runs1 += v1.service(h);
+        runs2 += v2.service(h);
+        v3.service(h);
+        runs4 += v4.service(h);
+        std::this_thread::sleep_for(std::chrono::milliseconds(EZ_PIXEL_SPEED_MIN + 1));
+    }
+
+    HOST_CHECK(runs1 > 1 && runs2 > 1 && !runs4, "runs %u %u %u", runs1, runs2, runs4);
+    HOST_CHECK(h.getMode() == CUSTOM_FX2 && h.frames() == handlerFrames, "handler mode %u frames %u", h.getMode(),
+               h.frames());
+    HOST_CHECK(v1.getMode() == CUSTOM_FX1 && v3.getMode() == 39, "view modes %u %u", v1.getMode(), v3.getMode());
+
+    for (uint16_t n = 0; n < PIXELS; n++)
+    {
+        COLOR c = h.getPixel(n);
+
+        if (n >= 2 && n < 6)
+            HOST_CHECK(c.r == runs1 && c.g == 4, "pixel %u (%u,%u) v1", n, c.r, c.g);
+        else if (n >= 14)
+            HOST_CHECK(c.r == runs2 && c.g == PIXELS - 14, "pixel %u (%u,%u) v2", n, c.r, c.g);
+        else if (n < 8 || n >= 11)
+            HOST_CHECK(c.r == SENTINEL.r && c.g == SENTINEL.g && c.b == SENTINEL.b, "pixel %u (%u,%u,%u) outside", n,
+                       c.r, c.g, c.b);
+    }
+
+    // Every built-in effect through a view, over a handler running another
+    //
+    h.setMode(2);
+
+    for (uint8_t m = 1; m < MODE_COUNT; m++)
+    {
+        VIEW v(3, 11, m);
+
+        for (int i = 0; i < 50; i++)
+        {
+            h.trigger();
+            h.service();
+            v.service(h);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        HOST_CHECK(h.getMode() == 2, "view %u left handler in mode %u", m, h.getMode());
+    }
+
+    return HOST_RESULT();
+}
@@ -17,10 +17,20 @@
 using namespace EZ;
 
 ACTIVITY::ACTIVITY(const char* name, MODE mode)
-    : _mode(mode), _name(name), _homeService(nullptr), _prevActivity(nullptr), _nextActivity(nullptr)
+    : _mode(mode), _name(name ? name : ""), _hash(hashName(name)), _id(USHRT_MAX), _homeService(nullptr),
+      _prevActivity(nullptr), _nextActivity(nullptr)
 {
 }
 
+uint32_t ACTIVITY::hashName(const char* name)
+{
+    uint32_t hash = 2166136261UL; // FNV-1a
+
+    while ((name) && *name)
+        hash = (hash ^ (uint8_t)*name++) * 16777619UL;
+    return hash;
+}
+
 int ACTIVITY::_takeServiceMutex(TickType_t xTicks)
 {
     if (_homeService)
@@ -42,4 +52,9 @@ bool ACTIVITY::_postCallback(SERVICE::CALLBACK type, void *vp)
     if ((_homeService) && _homeService->_onActivityCb && type != SERVICE::CALLBACK::LOOP)
         return _homeService->_onActivityCb(this, type, vp);
     return true;
-}
\ No newline at end of file
+}
+
+bool ACTIVITY::_hasCallback(void)
+{
+    return _homeService && _homeService->_onActivityCb;
+}
@@ -33,20 +33,27 @@ namespace EZ
         virtual ~ACTIVITY() {}
         ACTIVITY(const char* name, MODE mode);
         MODE mode(void) { return _mode; }
-        String name(void) { return _name; }
+        const char* name(void) const { return _name; }
+        uint32_t hash(void) const { return _hash; }
+        uint16_t id(void) const { return _id; }
         SERVICE* homeService(void) const { return _homeService; }
         ACTIVITY* nextActivity(void) const { return _nextActivity; }
         ACTIVITY* prevActivity(void) const { return _prevActivity; }
         virtual String upnpXML(bool valueTag = false, bool emptyTag = false) = 0;
 
+        static uint32_t hashName(const char* name);
+
     protected:
         int _takeServiceMutex(TickType_t xTicks = portMAX_DELAY);
         int _giveServiceMutex(void);
         bool _postCallback(SERVICE::CALLBACK type, void *vp = nullptr);
+        bool _hasCallback(void);
 
     private:
         MODE _mode;
-        String _name;
+        const char* _name; // Not copied, must outlive us (normally a literal)
+        uint32_t _hash;
+        uint16_t _id; // Dense index within our service
         SERVICE* _homeService;
         ACTIVITY* _prevActivity;
         ACTIVITY* _nextActivity;
@@ -79,13 +79,23 @@
 #define EZ_MAX_HOST 62
 #define EZ_MAX_NAME 40
 
+#define EZ_NVS_DEBOUNCE 1000     // Write NVS changes once a service has been quiet this long (ms)...
+#define EZ_NVS_MAX_LATENCY 10000 // ...or when its oldest unwritten change is this old (ms)
+#define EZ_NVS_FLUSH_TICK 100    // Persister polling period (ms)
+
 #define EZ_SSDP_METHOD_SIZE 10
 #define EZ_SSDP_URI_SIZE 2
 #define EZ_SSDP_BUFFER_SIZE 64
 #define EZ_SSDP_ADVERT_AGE 1800
+#define EZ_SSDP_DNSSD_ADVERT_AGE 7200 // CACHE-CONTROL max-age when devices are also published by DNS-SD
+#define EZ_DNSSD_SERVICE "_eziot"     // DNS-SD service type every device is published under (_tcp)
 #define EZ_SSDP_MULTICAST_TTL 2
 #define EZ_SSDP_MULTICAST_PORT 1900
 #define EZ_SSDP_MULTICAST_ADDR IPAddress(239, 255, 255, 250)
+#define EZ_SSDP_SEARCH_CACHE 8 // Recent M-SEARCH's remembered for duplicate suppression
+#define EZ_SSDP_REPLY_SOURCES 8 // Control points tracked for reply rate limiting
+#define EZ_SSDP_REPLY_BURST 32  // Max replies sent to a control point in one burst...
+#define EZ_SSDP_REPLY_RATE 8    // ...refilled at this many per second
 
 #define EZ_UPNP_UUID_DEVICE_PREFIX "50fbbdab-5418-41c1-a96d-"
 #define EZ_UPNP_SCHEMA_DEVICE_XMLNS "urn:schemas-upnp-org:device-1-0"
@@ -35,7 +35,7 @@ static const char _device_icon_list[] =
     "</iconList>\r\n";
 
 DEVICE::DEVICE(uint16_t port)
-    : _upnpVersionMajor(1), _upnpVersionMinor(0), _upnpXMLNS(nullptr), _upnpDeviceType(nullptr),
+    : _upnpVersionMajor(1), _upnpVersionMinor(0), _upnpConfigId(1), _upnpXMLNS(nullptr), _upnpDeviceType(nullptr),
       _upnpManufacturer(nullptr), _upnpManufacturerURL(nullptr), _upnpModelDescription(nullptr),
       _upnpModelName(nullptr), _upnpModelNumber(nullptr), _upnpModelURL(nullptr), _upnpSerialNumber(nullptr),
       _upnpUDN(nullptr), _upnpUPC(nullptr), _upnpExtra(nullptr), _ssdpExtra(nullptr), _homeDevice(nullptr),
@@ -61,31 +61,6 @@ String DEVICE::ssdpModel(void)
     return model;
 }
 
-/*
-** SSDP Matcher
-*/
-bool DEVICE::ssdpMatch(String& st)
-{
-    String _dt(upnpDeviceType());
-    String _st(st);
-    int w;
-
-    _dt.toLowerCase();
-    _st.toLowerCase();
-
-    // Fudge for Wemo's
-    if ((w = _st.lastIndexOf("**")) > 0)
-        _st = _st.substring(0, w);
-
-    if (_dt.startsWith(_st))
-    {
-        // ESP_LOGD(eziotString, "%s == %s", st.c_str(), upnpDeviceType().c_str());
-        return true;
-    }
-
-    return false;
-}
-
 /*
 ** UPNP
 */
@@ -96,7 +71,12 @@ String DEVICE::upnpXML(bool root)
     if (root)
     {
         xml.concat("<?xml version=\"1.0\"?>\r\n");
-        xml.concat("<root xmlns=\"" + upnpXMLNS() + "\">\r\n");
+        xml.concat("<root xmlns=\"" + upnpXMLNS() + "\"");
+
+        if (upnpBootIds())
+            xml.concat(" configId=\"" + upnpConfigId() + "\"");
+
+        xml.concat(">\r\n");
         xml.concat("<specVersion>\r\n");
         xml.concat(xmlTag("major", upnpVersionMajor()));
         xml.concat(xmlTag("minor", upnpVersionMinor()));
@@ -43,7 +43,6 @@ namespace EZ
 
         void ssdpAdverts(bool advertise) { _ssdpAdverts = advertise; }
         bool ssdpAlive(void) { return _ssdpAdverts; }
-        virtual bool ssdpMatch(String& st);
         virtual String ssdpModel(void);
         virtual String ssdpExtra(void) { return _ssdpExtra; }
 
@@ -51,6 +50,9 @@ namespace EZ
         virtual String upnpXMLNS(void);
         virtual String upnpVersionMajor(void) { return String(_upnpVersionMajor); }
         virtual String upnpVersionMinor(void) { return String(_upnpVersionMinor); }
+        virtual String upnpConfigId(void) { return String(_upnpConfigId); }
+        // UPnP 1.1 and later, descriptions carry configId and SSDP the BOOTID/CONFIGID headers
+        bool upnpBootIds(void) { return _upnpVersionMajor >= 2 || (_upnpVersionMajor == 1 && _upnpVersionMinor > 0); }
         virtual String upnpDeviceType(void);
         virtual String upnpFriendlyName(void);
         virtual void upnpFriendlyName(const char* name);
@@ -90,6 +92,7 @@ namespace EZ
     protected:
         uint16_t _upnpVersionMajor;
         uint16_t _upnpVersionMinor;
+        uint32_t _upnpConfigId;
         const char* _upnpXMLNS = nullptr;
         const char* _upnpDeviceType = nullptr;
         const char* _upnpManufacturer = nullptr;
@@ -14,18 +14,25 @@
 #include "ez_service.h"
 #include "ez_activity.h"
 #include "ez_device.h"
+#include "ez_variable.h"
 
 using namespace EZ;
 
 SERVICE::SERVICE(MODE mode, const char* name)
     : _mode(mode), _name(name), _baseDevice(nullptr), _prevService(nullptr), _nextService(nullptr),
-      _headActivity(nullptr), _tailActivity(nullptr), _onActivityCb(nullptr), _iotCode(0), _nvsHandle(0)
+      _headActivity(nullptr), _tailActivity(nullptr), _onActivityCb(nullptr), _iotCode(0), _activities(nullptr),
+      _activityCount(0), _nvsHandle(0),
+      _nvsVersion(0), _nvsPending(0), _nvsFirstChange(0), _nvsLastChange(0), _nvsWrites(0), _nvsAvoided(0)
 {
     // _mutexLock = xSemaphoreCreateMutex();
     _mutexLock = xSemaphoreCreateRecursiveMutex();
 }
 
-SERVICE::~SERVICE() { vSemaphoreDelete(_mutexLock); };
+SERVICE::~SERVICE()
+{
+    vSemaphoreDelete(_mutexLock);
+    free(_activities);
+};
 
 ACTIVITY& SERVICE::addActivity(ACTIVITY& newActivity)
 {
@@ -54,16 +61,57 @@ ACTIVITY* SERVICE::addActivity(ACTIVITY* newActivity)
 
         newActivity->_homeService = this;
 
-        if (_mode == MODE::CONFIG && newActivity->_mode == ACTIVITY::MODE::VARIABLE)
+        // Dense activity id
+        if (!(_activityCount & 7))
+        {
+            ACTIVITY** activities = (ACTIVITY**)realloc(_activities, (_activityCount + 8) * sizeof(ACTIVITY*));
+
+            if (!activities)
+            {
+                ESP_LOGE(iotTag, "SERVICE: No memory to index %s", newActivity->name());
+                return newActivity;
+            }
+            _activities = activities;
+        }
+
+        newActivity->_id = _activityCount;
+        _activities[_activityCount++] = newActivity;
+
+        if (newActivity->_mode == ACTIVITY::MODE::VARIABLE)
         {
             VARIABLE* var = reinterpret_cast<VARIABLE*>(newActivity);
-            var->_nvs = true;
+
+            if (_mode == MODE::CONFIG)
+                var->_nvs = true;
+
+            // Dense variable index, for the dirty bitmap
+            if (!_changes.add(var))
+                ESP_LOGE(iotTag, "SERVICE: No memory to index %s", var->name());
         }
     }
 
     return newActivity;
 }
 
+/*
+** Names are only unique within a mode (an ACTION and a VARIABLE may share one),
+** so the lookup filters on mode before comparing names.
+*/
+ACTIVITY* SERVICE::findActivity(const char* name, ACTIVITY::MODE mode)
+{
+    uint32_t hash = ACTIVITY::hashName(name);
+
+    for (uint16_t id = 0; id < _activityCount; id++)
+    {
+        ACTIVITY* activity = _activities[id];
+
+        if (activity->_mode == mode && activity->_hash == hash && strcmp(activity->_name, name) == 0)
+            return activity;
+    }
+
+    return nullptr;
+}
+
 String SERVICE::urlBase(const char* path)
 {
     uint16_t port = 80; //_web.webPort();
@@ -101,3 +149,223 @@ void SERVICE::_sendCommonHeaders(HTTP::SERVER& server, bool incServer)
     server.sendHeader("DATE", dateRFC1123());
     server.sendHeader("CONTENT-LANGUAGE", "en");
 }
+
+/*
+** Change tracking, see CHANGES. Changes are recorded under the service mutex, so queries
+** take it too.
+*/
+void SERVICE::_varChange(VARIABLE* var) { _changes.change(var); }
+
+int SERVICE::changedSince(uint32_t since, VARIABLE** list, int max)
+{
+    int count;
+
+    xSemaphoreTakeRecursive(_mutexLock, portMAX_DELAY);
+    count = _changes.since(since, list, max);
+    xSemaphoreGiveRecursive(_mutexLock);
+
+    return count;
+}
+
+/*
+** NVS write-behind, changes to persisted variables are only marked here (under the
+** service mutex) and written out later by the IOT persister in a single commit.
+*/
+void SERVICE::_nvsChange(VARIABLE* var)
+{
+    uint32_t now = millis();
+
+    if (var->_nvsDirty)
+        _nvsAvoided++;
+    else
+    {
+        var->_nvsDirty = true;
+
+        if (!_nvsPending++)
+            _nvsFirstChange = now;
+    }
+
+    _nvsLastChange = now;
+}
+
+/*
+** Only the bookkeeping is done under the service mutex: the dirty variables are taken (and
+** marked clean) in one pass, the flash writes and commit run without it so SOAP, HTTP and
+** native() callers are never stalled behind flash, then any that failed are marked dirty
+** again. A variable changed mid-write is re-marked by _nvsChange() and written next time.
+*/
+void SERVICE::_nvsFlush(bool force, uint32_t debounce, uint32_t maxLatency)
+{
+    VARIABLE** dirty = nullptr;
+    uint32_t version = 0;
+    uint32_t now;
+    int count = 0;
+
+    xSemaphoreTakeRecursive(_mutexLock, portMAX_DELAY);
+
+    // Pending and its timestamps are written under the mutex, so only read them under it
+    now = millis();
+
+    if (_nvsPending && (force || (now - _nvsLastChange) >= debounce || (now - _nvsFirstChange) >= maxLatency))
+    {
+        // On the heap, the persister's stack doesn't grow with the service
+        if ((dirty = (VARIABLE**)malloc(_changes.count() * sizeof(VARIABLE*))))
+        {
+            int changed = changedSince(_nvsVersion, dirty, _changes.count());
+
+            for (int i = 0; i < changed; i++)
+            {
+                if (dirty[i]->_nvsDirty)
+                {
+                    dirty[i]->_nvsDirty = false;
+                    dirty[count++] = dirty[i];
+                }
+            }
+
+            version = _changes.version();
+            _nvsPending = 0;
+        }
+        else
+            ESP_LOGE(iotTag, "NVS: No memory to flush %s", _name);
+    }
+
+    xSemaphoreGiveRecursive(_mutexLock);
+
+    if (!dirty)
+        return;
+
+    uint16_t written = 0;
+    uint16_t failed = 0;
+
+    // No handle, nothing can be written or retried
+    if (_nvsHandle)
+    {
+        // Failures are gathered at the front of the list
+        for (int i = 0; i < count; i++)
+        {
+            if (dirty[i]->_nvsSave(false))
+                written++;
+            else
+                dirty[failed++] = dirty[i];
+        }
+
+        esp_err_t err = nvs_commit(_nvsHandle);
+
+        if (err)
+        {
+            ESP_LOGV(iotTag, "NVS: Commit failed: %s %s", _name, nvs_error(err));
+            written = 0;
+            failed = count;
+        }
+    }
+
+    xSemaphoreTakeRecursive(_mutexLock, portMAX_DELAY);
+
+    _nvsWrites += written;
+
+    if (failed)
+    {
+        // Keep _nvsVersion so they are found again, retry after the debounce
+        now = millis();
+
+        for (int i = 0; i < failed; i++)
+        {
+            if (!dirty[i]->_nvsDirty)
+            {
+                dirty[i]->_nvsDirty = true;
+
+                if (!_nvsPending++)
+                    _nvsFirstChange = now;
+            }
+        }
+
+        _nvsLastChange = now;
+    }
+    else
+        _nvsVersion = version;
+
+    xSemaphoreGiveRecursive(_mutexLock);
+
+    free(dirty);
+}
+
+/*
+** NVS preload, called at INIT so that no variable has to lazy load (and touch flash) on
+** its first read.
+**
+** On IDF 4 and later one pass over the NVS entries in our namespace (nvs_entry_find) loads
+** what is stored, anything without an entry simply keeps its default. IDF 3.x, which the
+** current Arduino core is built on, has no NVS iterator, there each persisted variable is
+** loaded with its own nvs_get (still all at INIT, rather than on first read).
+*/
+uint16_t SERVICE::_nvsPreload(const char* tag)
+{
+    ACTIVITY* activity;
+    uint16_t loaded = 0;
+
+    if (!_nvsHandle)
+        return 0;
+
+    xSemaphoreTakeRecursive(_mutexLock, portMAX_DELAY);
+
+#if defined(ESP_IDF_VERSION_MAJOR) && ESP_IDF_VERSION_MAJOR >= 4
+    nvs_iterator_t it;
+    nvs_entry_info_t info;
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+    if (nvs_entry_find(NVS_DEFAULT_PART_NAME, tag, NVS_TYPE_ANY, &it) != ESP_OK)
+        it = nullptr;
+#else
+    it = nvs_entry_find(NVS_DEFAULT_PART_NAME, tag, NVS_TYPE_ANY);
+#endif
+
+    while (it)
+    {
+        nvs_entry_info(it, &info);
+
+        if ((activity = findActivity(info.key, ACTIVITY::MODE::VARIABLE)))
+        {
+            VARIABLE* var = reinterpret_cast<VARIABLE*>(activity);
+
+            if (var->_nvs && !var->_nvsLoaded && var->_nvsLoad())
+                loaded++;
+        }
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+        if (nvs_entry_next(&it) != ESP_OK)
+            it = nullptr;
+#else
+        it = nvs_entry_next(it);
+#endif
+    }
+
+    nvs_release_iterator(it);
+
+    for (activity = _headActivity; activity; activity = activity->nextActivity())
+    {
+        if (activity->mode() == ACTIVITY::MODE::VARIABLE)
+        {
+            VARIABLE* var = reinterpret_cast<VARIABLE*>(activity);
+
+            if (var->_nvs)
+                var->_nvsLoaded = true;
+        }
+    }
+#else
+    // No entry iteration, one get per persisted variable
+    for (activity = _headActivity; activity; activity = activity->nextActivity())
+    {
+        if (activity->mode() == ACTIVITY::MODE::VARIABLE)
+        {
+            VARIABLE* var = reinterpret_cast<VARIABLE*>(activity);
+
+            if (var->_nvs && !var->_nvsLoaded && var->_nvsLoad())
+                loaded++;
+        }
+    }
+#endif
+
+    xSemaphoreGiveRecursive(_mutexLock);
+
+    return loaded;
+}
@@ -15,6 +15,7 @@
 #define _EZ_SERVICE_H
 #include "ez_common.h"
 #include "ez_http.h"
+#include "tool/ez_changes.h"
 
 namespace EZ
 {
@@ -31,6 +32,7 @@ namespace EZ
         friend class ACTIVITY;
         friend class DEVICE;
         friend class IOT;
+        friend class VARIABLE;
 
     public:
         typedef struct _event_t
@@ -70,12 +72,18 @@ namespace EZ
         ACTIVITY* addActivity(ACTIVITY* newActivity);
         ACTIVITY* headActivity(void) const { return _headActivity; }
         ACTIVITY* tailActivity(void) const { return _tailActivity; }
+        ACTIVITY* activity(uint16_t id) const { return id < _activityCount ? _activities[id] : nullptr; }
+        ACTIVITY* findActivity(const char* name, ACTIVITY::MODE mode);
         DEVICE* baseDevice(void) const { return _baseDevice; }
         SERVICE* nextService(void) const { return _nextService; }
         SERVICE* prevService(void) const { return _prevService; }
 
         SemaphoreHandle_t mutexLock(void) const { return _mutexLock; }
         uint32_t nvsHandle(void) const { return _nvsHandle; }
+        uint32_t version(void) const { return _changes.version(); }
+        int changedSince(uint32_t since, VARIABLE** list, int max);
+        uint32_t nvsWrites(void) const { return _nvsWrites; }
+        uint32_t nvsAvoided(void) const { return _nvsAvoided; }
 
         String urlBase(const char* path = nullptr);
         String uuidDevice(void);
@@ -102,8 +110,22 @@ namespace EZ
 
     private:
         uint32_t _iotCode;
+        CHANGES<VARIABLE> _changes; // Variable change versions
+        ACTIVITY** _activities; // Indexed by ACTIVITY::_id
+        uint16_t _activityCount;
         uint32_t _nvsHandle;
+        uint32_t _nvsVersion;     // Version at the last flush
+        uint16_t _nvsPending;     // Variables with unwritten changes
+        uint32_t _nvsFirstChange; // millis() of the oldest unwritten change
+        uint32_t _nvsLastChange;  // ... and of the newest
+        uint32_t _nvsWrites;
+        uint32_t _nvsAvoided;
         SemaphoreHandle_t _mutexLock;
+
+        void _varChange(VARIABLE* var);
+        void _nvsChange(VARIABLE* var);
+        void _nvsFlush(bool force, uint32_t debounce, uint32_t maxLatency);
+        uint16_t _nvsPreload(const char* tag);
         SERVICE(SERVICE const& copy);            // Not Implemented
         SERVICE& operator=(SERVICE const& copy); // Not Implemented
     };
@@ -15,21 +15,28 @@
 #define _EZ_VARIABLE_H
 #include "ez_activity.h"
 #include "ez_common.h"
+#include "tool/ez_versioned.h"
 
 //        uint32_t _nvsHandle;
 
 namespace EZ
 {
+    namespace VAR
+    {
+        class HISTORY;
+    }
+
     class VARIABLE : public ACTIVITY
     {
         friend class IOT;
         friend class SERVICE;
+        template<class> friend class CHANGES;
 
     public:
         virtual ~VARIABLE() {}
         VARIABLE(const char* name, const char* type, bool events, bool nvs, size_t size)
             : ACTIVITY(name, ACTIVITY::MODE::VARIABLE), _events(events), _nvs(nvs), _size(size), _type(type),
-              _nvsLoaded(false)
+              _nvsLoaded(false), _nvsDirty(false), _index(USHRT_MAX), _changedVersion(0)
         {
         }
 
@@ -49,34 +56,29 @@ namespace EZ
             {
                 if ((_hasChanged = _setValue(newValue)))
                 {
-                    if (_postCallback(SERVICE::CALLBACK::POST_CHANGE))
-                    {
-                        // Save to NVS?
-                        if (_nvs && homeService())
-                            _nvsSave();
-
-                        if (_events && homeService())
-                            homeService()->registerEvent(this);
-                    }
+                    _publish();
+                    _postChange();
                 }
             }
 
             _giveServiceMutex();
 
-            // ESP_LOGV(iotTag, "%s - hasChanged: %d", name().c_str(), _hasChanged);
+            // ESP_LOGV(iotTag, "%s - hasChanged: %d", name(), _hasChanged);
 
             return _hasChanged;
         }
 
         String value(void)
         {
-            _takeServiceMutex();
             if (_nvs && !_nvsLoaded)
-                (void)_nvsLoad();
-            String value = _getValue();
-            _giveServiceMutex();
+            {
+                _takeServiceMutex();
+                if (!_nvsLoaded)
+                    (void)_nvsLoad();
+                _giveServiceMutex();
+            }
 
-            return value;
+            return _readValue();
         }
 
         String upnpXML(bool valueTag = false, bool emptyTag = false)
@@ -84,7 +86,7 @@ namespace EZ
             if (valueTag)
             {
                 // Encode Value?
-                return xmlTag(name().c_str(), value(), emptyTag);
+                return xmlTag(name(), value(), emptyTag);
             }
 
             String xml("<stateVariable sendEvents=\"{e}\">\r\n");
@@ -99,6 +101,8 @@ namespace EZ
         }
 
         bool upnpEventable(void) { return _events; }
+        uint32_t changedVersion(void) const { return _changedVersion; }
+        virtual VAR::HISTORY* history(void) { return nullptr; }
         virtual String defaultValue(void) { return ""; }
         virtual int validate(String& val) = 0;
 
@@ -108,6 +112,79 @@ namespace EZ
         size_t _size;
         String _type;
         bool _nvsLoaded;
+        bool _nvsDirty;
+        uint16_t _index;          // Dense index within our service
+        uint32_t _changedVersion; // Service version of our last change
+
+        /*
+        ** Typed update, used by the native() setters of the VAR:: classes. The new value is
+        ** compared (and by then validated) in its native type. PRE_CHANGE callbacks are passed
+        ** the proposed value as text, as value(String) passes it, but the text is only built
+        ** when a callback is registered so without one there's no conversion or allocation.
+        ** A callback that edits the text has its edit applied as value(String) would.
+        */
+        template<class _T, class _TEXT> bool _nativeValue(_T& activeValue, _T newValue, _TEXT toText)
+        {
+            bool _hasChanged = false;
+
+            if (!_takeServiceMutex())
+                return false;
+
+            if (activeValue != newValue)
+            {
+                if (!_hasCallback())
+                {
+                    activeValue = newValue;
+                    _hasChanged = true;
+                }
+                else
+                {
+                    String proposed(toText(newValue));
+                    String original(proposed);
+
+                    if (_postCallback(SERVICE::CALLBACK::PRE_CHANGE, &proposed))
+                    {
+                        if (proposed == original)
+                        {
+                            activeValue = newValue;
+                            _hasChanged = true;
+                        }
+                        else
+                            _hasChanged = _setValue(proposed);
+                    }
+                }
+
+                if (_hasChanged)
+                {
+                    _publish();
+                    _postChange();
+                }
+            }
+
+            _giveServiceMutex();
+
+            return _hasChanged;
+        }
+
+        void _postChange(void)
+        {
+            if (homeService())
+                homeService()->_varChange(this);
+
+            if (_postCallback(SERVICE::CALLBACK::POST_CHANGE))
+            {
+                // Save to NVS? - deferred to the IOT persister, our value is now the
+                // one to keep so must not be overwritten by a lazy _nvsLoad()
+                if (_nvs && homeService())
+                {
+                    _nvsLoaded = true;
+                    homeService()->_nvsChange(this);
+                }
+
+                if (_events && homeService())
+                    homeService()->registerEvent(this);
+            }
+        }
 
         bool _nvsErase(void)
         {
@@ -115,15 +192,15 @@ namespace EZ
                 return false;
 
             uint32_t nvsHandle = homeService()->nvsHandle();
-            esp_err_t err = nvs_erase_key(nvsHandle, name().c_str());
+            esp_err_t err = nvs_erase_key(nvsHandle, name());
 
             if (err)
             {
-                ESP_LOGV(iotTag, "NVS: Erase key failed: %s %s", name().c_str(), nvs_error(err));
+                ESP_LOGV(iotTag, "NVS: Erase key failed: %s %s", name(), nvs_error(err));
                 return false;
             }
 
-            ESP_LOGV(iotTag, "NVS: Loaded OK: %s", name().c_str());
+            ESP_LOGV(iotTag, "NVS: Loaded OK: %s", name());
 
             return true;
         }
@@ -141,20 +218,22 @@ namespace EZ
 
                 if ((err) && err != ESP_ERR_NVS_NOT_FOUND)
                 {
-                    ESP_LOGV(iotTag, "NVS: Get failed: %s %s", name().c_str(), nvs_error(err));
+                    ESP_LOGV(iotTag, "NVS: Get failed: %s %s", name(), nvs_error(err));
                     return false;
                 }
                 else
                     _nvsLoaded = true;
 
-                ESP_LOGV(iotTag, "NVS: Loaded OK: %s", name().c_str());
+                _publish();
+
+                ESP_LOGV(iotTag, "NVS: Loaded OK: %s", name());
 
                 return true;
             }
             return false;
         }
 
-        bool _nvsSave(void)
+        bool _nvsSave(bool commit = true)
         {
             if (!homeService())
                 return false;
@@ -165,23 +244,21 @@ namespace EZ
             {
                 esp_err_t err = _saveValue(nvsHandle);
 
-                ESP_LOGV(iotTag, "NVS: %s %s", name().c_str(), nvs_error(err));
+                ESP_LOGV(iotTag, "NVS: %s %s", name(), nvs_error(err));
 
                 if (err)
                 {
-                    ESP_LOGV(iotTag, "NVS: Set failed: %s %s", name().c_str(), nvs_error(err));
+                    ESP_LOGV(iotTag, "NVS: Set failed: %s %s", name(), nvs_error(err));
                     return false;
                 }
 
-                err = nvs_commit(nvsHandle);
-
-                if (err)
+                if (commit && (err = nvs_commit(nvsHandle)))
                 {
-                    ESP_LOGV(iotTag, "NVS: Commit failed: %s %s", name().c_str(), nvs_error(err));
+                    ESP_LOGV(iotTag, "NVS: Commit failed: %s %s", name(), nvs_error(err));
                     return false;
                 }
 
-                ESP_LOGV(iotTag, "NVS: Saved OK: %s", name().c_str());
+                ESP_LOGV(iotTag, "NVS: Saved OK: %s", name());
 
                 return true;
             }
@@ -189,10 +266,24 @@ namespace EZ
         }
 
         virtual esp_err_t _loadValue(uint32_t nvsHandle) = 0;
+        // Called by the persister without the service mutex, so the flash write doesn't stall
+        // other callers: write the published copy, or copy the value out under the mutex
         virtual esp_err_t _saveValue(uint32_t nvsHandle) = 0;
         virtual bool _setValue(String& val) = 0;
         virtual String _getValue(void) = 0;
         virtual String _allowedTags(void) { return ""; }
+
+        // Lock free reads - scalar variables keep a VERSIONED copy of their value, which
+        // _publish() updates after every change (under the service mutex)
+        virtual void _publish(void) {}
+        virtual String _readValue(void)
+        {
+            _takeServiceMutex();
+            String value = _getValue();
+            _giveServiceMutex();
+
+            return value;
+        }
     };
 } // namespace EZ
 
@@ -203,6 +294,7 @@ namespace EZ
 #include "var/var_boolean.h"
 #include "var/var_char.h"
 #include "var/var_enum.h"
+#include "var/var_history.h"
 #include "var/var_numeric.h"
 #include "var/var_period.h"
 #include "var/var_string.h"
@@ -16,6 +16,7 @@
 #include "core/tool/ez_color.h"
 #include "pixel/pixel_handler.h"
 #include "pixel/pixel_segment.h"
+#include "pixel/pixel_layers.h"
 
 namespace EZ
 {   
@@ -16,9 +16,12 @@
 */
 #ifndef _EZ_HAL_NEO_H
 #define _EZ_HAL_NEO_H
+#include "core/ez_common.h"
 #include "core/tool/ez_color.h"
 #include "pixel/pixel_handler.h"
 #include "pixel/pixel_segment.h"
+#include "pixel/pixel_layers.h"
+#include "pixel/pixel_rmt.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -31,12 +34,15 @@ extern "C"
 #include "esp32-hal.h"
 #include "esp_intr.h"
 #include "freertos/semphr.h"
+#include "rom/gpio.h"
+#include "soc/gpio_sig_map.h"
 #include "soc/rmt_struct.h"
 #elif defined(ESP_PLATFORM)
 #include <driver/gpio.h>
 #include <esp_intr.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <rom/gpio.h>
 #include <soc/dport_reg.h>
 #include <soc/gpio_sig_map.h>
 #include <soc/rmt_struct.h>
@@ -47,6 +53,7 @@ extern "C"
 #ifdef __cplusplus
 }
 #endif
+#include <initializer_list>
 
 namespace EZ
 {
@@ -56,8 +63,10 @@ namespace EZ
         //
         class STRAND;
         class DRIVER;
+        class PARALLEL;
 
         static IRAM_ATTR void __rmtCopyBlock(STRAND* pStrand);
+        static IRAM_ATTR void __rmtLoad(DRIVER* pDriver, STRAND* pStrand);
         static IRAM_ATTR void __rmtInterrupt(void* arg);
 
         // Pixel types and associtaed timings
@@ -115,14 +124,21 @@ namespace EZ
             static_cast<uint32_t>(1) << (0 + 6) * 3, static_cast<uint32_t>(1) << (0 + 7) * 3,
         };
 
-        // A channel has a 64 "pulse" buffer - we use half per pass
+        // A channel memory block has a 64 "pulse" buffer - we use half per pass
         static DRAM_ATTR const uint16_t MAX_PULSES = 32;
+        // A channel can borrow the blocks of the channels above it (which can't then be used)
+        static DRAM_ATTR const uint16_t MAX_BLOCKS = 8;
+        // There is a channel per block
+        static DRAM_ATTR const uint16_t MAX_CHANNELS = MAX_BLOCKS;
         // 8 still seems to work, but timings become marginal
         static DRAM_ATTR const uint16_t DIVIDER = 4;
         // Minimum time of a single RMT duration based on clock ns
         static DRAM_ATTR const double RMT_DURATION_NS = 12.5;
-        // In theory upto 8!
-        static DRAM_ATTR const uint16_t MAX_STRANDS = 4;
+        // Default frame budget (us), 60 fps
+        static const uint32_t FRAME_BUDGET = 1000000 / 60;
+
+        // Guards starting all the channels of a frame together
+        static portMUX_TYPE __rmtMux = portMUX_INITIALIZER_UNLOCKED;
 
         class RENDER
         {
@@ -136,19 +152,70 @@ namespace EZ
         {
         public:
             friend class DRIVER;
+            friend class PARALLEL;
             friend IRAM_ATTR void __rmtCopyBlock(STRAND* pStrand);
+            friend IRAM_ATTR void __rmtLoad(DRIVER* pDriver, STRAND* pStrand);
             friend IRAM_ATTR void __rmtInterrupt(void* arg);
 
-            STRAND(PIXEL::pixel_order_t order, uint16_t count, neo_type_t type, uint8_t gpio, rmt_channel_t rmt)
-                : HANDLER(order, count), _rmtChannel(rmt), _rmtPin((gpio_num_t)gpio), _neoType(type),
-                  _neoRender(nullptr), _rmtSemaphore(nullptr), _rmtIndex(0), _rmtHalf(0), _rmtDirty(false)
+            // rmt = channel to use, or RMT_CHANNEL_MAX to have the DRIVER allocate one
+            // blocks = RMT memory blocks (1-8) wanted for the channel, more blocks means fewer
+            // refill interrupts per frame, but channels rmt+1 .. rmt+blocks-1 can't then be used.
+            //
+            STRAND(PIXEL::pixel_order_t order, uint16_t count, neo_type_t type, uint8_t gpio,
+                   rmt_channel_t rmt = RMT_CHANNEL_MAX, uint8_t blocks = 1)
+                : HANDLER(order, count), _rmtChannel(RMT_CHANNEL_MAX), _rmtWant(rmt), _rmtPin((gpio_num_t)gpio),
+                  _neoType(type), _neoRender(nullptr), _rmtNext(nullptr), _rmtShared(false), _rmtBlocks(blocks),
+                  _rmtPulses(MAX_PULSES), _rmtReset(0), _rmtData(nullptr), _rmtSemaphore(nullptr),
+                  _rmtNotify(nullptr), _rmtIndex(0), _rmtHalf(0), _rmtDirty(false), _rmtBusy(false),
+                  _rmtQueued(false), _rmtFrame(false), _rmtStart(0), _rmtTime(0), _rmtLatency(0)
             {
             }
 
-            virtual ~STRAND() {}
+            virtual ~STRAND()
+            {
+                wait();
+
+                if (_rmtSemaphore)
+                    vSemaphoreDelete(_rmtSemaphore);
+                if (_rmtData)
+                    free(_rmtData);
+            }
 
             void render(void) { if (_neoRender) _neoRender->render(this); }
 
+            // Rendering is asynchronous, render() returns as soon as the frame has started to clock
+            // out, leaving the pixels free for the next frame.
+            //
+            // busy() - frame still being transmitted
+            // wait() - block until it has gone (or timeout), true if the strand is idle
+            // notify() - task to be sent a notification (xTaskNotifyGive) as each frame completes
+            //
+            bool busy(void) { return _rmtBusy; }
+
+            bool wait(TickType_t timeout = portMAX_DELAY)
+            {
+                if (!_rmtSemaphore || !_rmtBusy)
+                    return true;
+
+                if (xSemaphoreTake(_rmtSemaphore, timeout) != pdTRUE)
+                    return false;
+
+                xSemaphoreGive(_rmtSemaphore);
+                return true;
+            }
+
+            void notify(TaskHandle_t task) { _rmtNotify = task; }
+
+            // Duration (us) of the last frame, from start of transmission to end of reset
+            //
+            uint32_t frameTime(void) { return _rmtTime; }
+
+            // Channel allocated by the DRIVER (RMT_CHANNEL_MAX if none), and whether the strand is
+            // time-multiplexed with others on it
+            //
+            rmt_channel_t channel(void) { return _rmtChannel; }
+            bool shared(void) { return _rmtShared; }
+
         protected:
             typedef union {
                 struct
@@ -161,67 +228,185 @@ namespace EZ
                 uint32_t val;
             } rmt_pulse_t;
 
-            rmt_pulse_t _rmtPulsePair[2];
-            rmt_channel_t _rmtChannel;
+            PIXEL::rmt_table_t _rmtTable;
+            rmt_channel_t _rmtChannel; // Allocated
+            rmt_channel_t _rmtWant;    // Requested
             gpio_num_t _rmtPin;
             neo_type_t _neoType;
             RENDER* _neoRender;
-
-            volatile xSemaphoreHandle _rmtSemaphore;
+            STRAND* _rmtNext; // Next to go on a shared channel this frame
+            bool _rmtShared;
+            uint8_t _rmtBlocks;  // Memory blocks requested
+            uint16_t _rmtPulses; // Pulses per half of the channel memory
+            uint16_t _rmtReset;  // Reset duration, stretches the final pulse
+
+            uint8_t* _rmtData; // Front buffer, being clocked out (_wireData is the back buffer)
+            xSemaphoreHandle _rmtSemaphore; // Given when the front buffer is free
+            volatile TaskHandle_t _rmtNotify;
             volatile uint16_t _rmtIndex, _rmtHalf;
             volatile bool _rmtDirty;
+            volatile bool _rmtBusy;
+            volatile bool _rmtQueued; // Output this frame
+            volatile bool _rmtFrame;  // Part of a DRIVER::render() frame
+            volatile uint32_t _rmtStart, _rmtTime;
+            volatile uint32_t _rmtLatency; // Frame start to done
 
         private:
             STRAND(STRAND const& copy);            // Not Implemented
             STRAND& operator=(STRAND const& copy); // Not Implemented
         };
 
+        /*
+        ** DRIVER - Renders any number of strands over the RMT channels
+        **
+        ** Strands are given the channel they asked for, or the free channel with the most memory
+        ** blocks available. Once the channels run out strands share the least loaded channel,
+        ** the interrupt starting each in turn (switching the GPIO over) as the previous finishes.
+        */
         class DRIVER : public RENDER
         {
         public:
             friend class STRAND;
             friend IRAM_ATTR void __rmtCopyBlock(STRAND* pStrand);
+            friend IRAM_ATTR void __rmtLoad(DRIVER* pDriver, STRAND* pStrand);
             friend IRAM_ATTR void __rmtInterrupt(void* arg);
 
-            DRIVER(STRAND& s1) : _strands{&s1, nullptr, nullptr, nullptr} { _initialise(); }
-            DRIVER(STRAND& s1, STRAND& s2) : _strands{&s1, &s2, nullptr, nullptr} { _initialise(); }
-            DRIVER(STRAND& s1, STRAND& s2, STRAND& s3) : _strands{&s1, &s2, &s3, nullptr} { _initialise(); }
-            DRIVER(STRAND& s1, STRAND& s2, STRAND& s3, STRAND& s4) : _strands{&s1, &s2, &s3, &s4} { _initialise(); }
+            DRIVER() { _initialise(); }
+
+            template<class... _S> DRIVER(STRAND& s1, _S&... sn)
+            {
+                _initialise();
+
+                for (STRAND* pStrand : {&s1, &sn...})
+                    add(*pStrand);
+            }
+
+            ~DRIVER()
+            {
+                stop();
+
+                if (_strands)
+                    free(_strands);
+            }
+
+            // Add a strand, channels are (re)allocated on start()
+            //
+            bool add(STRAND& s)
+            {
+                STRAND** strands;
+
+                if (!(strands = (STRAND**)realloc(_strands, (_strandCount + 1) * sizeof(STRAND*))))
+                    return false;
+
+                _strands = strands;
+                _strands[_strandCount++] = &s;
+                s._neoRender = this;
+                return true;
+            }
 
-            ~DRIVER() { stop(); }
+            uint16_t strands(void) { return _strandCount; }
 
+            // Output every dirty strand, then start them all together so the frame takes as long as
+            // the busiest channel. Returns once they are started, use wait() to block until done.
+            //
             void render(void)
             {
-                for (int s = 0; s < MAX_STRANDS; s++)
+                STRAND* head[MAX_CHANNELS] = {nullptr};
+                STRAND* tail[MAX_CHANNELS] = {nullptr};
+                uint16_t count = 0;
+
+                if (!_started)
+                    return;
+
+                for (int s = 0; s < _strandCount; s++)
+                    _output(_strands[s]);
+
+                // Let the previous frame clear, then queue the strands of each channel
+                wait();
+
+                for (int s = 0; s < _strandCount; s++)
+                {
+                    STRAND* pStrand = _strands[s];
+
+                    if (pStrand->_rmtQueued)
+                    {
+                        int channel = pStrand->_rmtChannel;
+
+                        _swap(pStrand, true);
+
+                        if (tail[channel])
+                            tail[channel]->_rmtNext = pStrand;
+                        else
+                            head[channel] = pStrand;
+
+                        tail[channel] = pStrand;
+                        count++;
+                    }
+                }
+
+                if (count)
                 {
-                    if ((_strands[s]) && _strands[s]->_isDirty)
-                        render(_strands[s]);
+                    for (int c = 0; c < MAX_CHANNELS; c++)
+                    {
+                        if (head[c])
+                            __rmtLoad(this, head[c]);
+                    }
+
+                    portENTER_CRITICAL(&__rmtMux);
+                    _framePending = count;
+                    _frameStart = micros();
+                    for (int c = 0; c < MAX_CHANNELS; c++)
+                    {
+                        if (head[c])
+                            _start(head[c], _frameStart);
+                    }
+                    portEXIT_CRITICAL(&__rmtMux);
                 }
             }
 
+            // Output into the back buffer, then once the previous frame (and anything else on the
+            // channel) has cleared swap it to the front and start it clocking out. Returns without
+            // waiting for the transmission.
+            //
             void render(STRAND* pStrand)
             {
-                if ((pStrand) && pStrand->_isDirty)
-                {
-                    pStrand->_rmtIndex = 0;
-                    pStrand->_rmtHalf = 0;
-                    pStrand->_rmtDirty = 1;
-
-                    __rmtCopyBlock(pStrand);
-                    if (pStrand->_rmtIndex < pStrand->_pixelBytes)
-                        __rmtCopyBlock(pStrand);
+                if (!_started || !_output(pStrand))
+                    return;
 
-                    pStrand->_rmtSemaphore = xSemaphoreCreateBinary();
+                for (STRAND* active; (active = _active[pStrand->_rmtChannel]) && active->_rmtBusy;)
+                    active->wait();
+                pStrand->wait();
 
-                    RMT.conf_ch[pStrand->_rmtChannel].conf1.mem_rd_rst = 1;
-                    RMT.conf_ch[pStrand->_rmtChannel].conf1.tx_start = 1;
+                _swap(pStrand, false);
+                __rmtLoad(this, pStrand);
+                _start(pStrand, micros());
+            }
 
-                    xSemaphoreTake(pStrand->_rmtSemaphore, portMAX_DELAY);
-                    vSemaphoreDelete(pStrand->_rmtSemaphore);
-                    pStrand->_rmtSemaphore = NULL;
+            // Wait for all strands to finish transmitting, true if they have
+            //
+            bool wait(TickType_t timeout = portMAX_DELAY)
+            {
+                for (int s = 0; s < _strandCount; s++)
+                {
+                    if (!_strands[s]->wait(timeout))
+                        return false;
                 }
+
+                return true;
             }
 
+            // Duration (us) of the last complete render(), first channel start to last channel done
+            //
+            uint32_t frameTime(void) { return _frameTime; }
+
+            // Frame budget (us), 1000000 / fps, and the percentage of it a strand used last frame
+            // (from the start of the frame until it was done, so includes waiting for its turn on
+            // a shared channel)
+            //
+            void budget(uint32_t us) { _budget = max(us, (uint32_t)1); }
+            uint32_t budget(void) { return _budget; }
+            uint16_t budgetUsed(STRAND& s) { return ((uint64_t)s._rmtLatency * 100) / _budget; }
+
             void start(void)
             {
                 if (_started)
@@ -233,50 +418,79 @@ namespace EZ
                 RMT.apb_conf.fifo_mask = 1;      // Enable memory access, instead of FIFO mode
                 RMT.apb_conf.mem_tx_wrap_en = 1; // Wrap around when hitting end of buffer
 
-                for (int s = 0; s < MAX_STRANDS; s++)
+                _allocate();
+
+                for (int c = 0; c < MAX_CHANNELS; c++)
                 {
-                    if (!_strands[s])
+                    _active[c] = nullptr;
+
+                    if (!_blocks[c])
                         continue;
+
+                    RMT.conf_ch[c].conf0.div_cnt = DIVIDER;
+                    RMT.conf_ch[c].conf0.mem_size = _blocks[c];
+                    RMT.conf_ch[c].conf0.carrier_en = 0;
+                    RMT.conf_ch[c].conf0.carrier_out_lv = 1;
+                    RMT.conf_ch[c].conf0.mem_pd = 0;
+
+                    RMT.conf_ch[c].conf1.rx_en = 0;
+                    RMT.conf_ch[c].conf1.mem_owner = 0;
+                    RMT.conf_ch[c].conf1.tx_conti_mode = 0; // loop back mode
+                    RMT.conf_ch[c].conf1.ref_always_on = 1; // use apb clock: 80M
+                    RMT.conf_ch[c].conf1.idle_out_en = 1;
+                    RMT.conf_ch[c].conf1.idle_out_lv = 0;
+
+                    RMT.tx_lim_ch[c].limit = _blocks[c] * MAX_PULSES;
+
+                    RMT.int_ena.val |= __tx_thr_event_offsets[c]; // RMT.int_ena.ch<n>_tx_thr_event = 1;
+                    RMT.int_ena.val |= __tx_end_offsets[c];       // RMT.int_ena.ch<n>_tx_end = 1;
+                }
+
+                for (int s = 0; s < _strandCount; s++)
+                {
                     STRAND* pStrand = _strands[s];
                     neo_params_t ledParams = __neoParams[pStrand->_neoType];
+                    STRAND::rmt_pulse_t pulse[2];
 
-                    rmt_set_pin(pStrand->_rmtChannel, RMT_MODE_TX, pStrand->_rmtPin);
+                    if (pStrand->_rmtChannel >= MAX_CHANNELS)
+                        continue;
 
-                    RMT.conf_ch[pStrand->_rmtChannel].conf0.div_cnt = DIVIDER;
-                    RMT.conf_ch[pStrand->_rmtChannel].conf0.mem_size = 1;
-                    RMT.conf_ch[pStrand->_rmtChannel].conf0.carrier_en = 0;
-                    RMT.conf_ch[pStrand->_rmtChannel].conf0.carrier_out_lv = 1;
-                    RMT.conf_ch[pStrand->_rmtChannel].conf0.mem_pd = 0;
+                    if (!pStrand->_rmtSemaphore && (pStrand->_rmtSemaphore = xSemaphoreCreateBinary()))
+                        xSemaphoreGive(pStrand->_rmtSemaphore);
 
-                    RMT.conf_ch[pStrand->_rmtChannel].conf1.rx_en = 0;
-                    RMT.conf_ch[pStrand->_rmtChannel].conf1.mem_owner = 0;
-                    RMT.conf_ch[pStrand->_rmtChannel].conf1.tx_conti_mode = 0; // loop back mode
-                    RMT.conf_ch[pStrand->_rmtChannel].conf1.ref_always_on = 1; // use apb clock: 80M
-                    RMT.conf_ch[pStrand->_rmtChannel].conf1.idle_out_en = 1;
-                    RMT.conf_ch[pStrand->_rmtChannel].conf1.idle_out_lv = 0;
+                    if (pStrand->_rmtShared)
+                    {
+                        // Held low, the channel is switched over to it while it's being sent
+                        gpio_pad_select_gpio(pStrand->_rmtPin);
+                        gpio_set_direction(pStrand->_rmtPin, GPIO_MODE_OUTPUT);
+                        gpio_set_level(pStrand->_rmtPin, 0);
+                        gpio_matrix_out(pStrand->_rmtPin, SIG_GPIO_OUT_IDX, false, false);
+                    }
+                    else
+                        rmt_set_pin(pStrand->_rmtChannel, RMT_MODE_TX, pStrand->_rmtPin);
 
-                    RMT.tx_lim_ch[pStrand->_rmtChannel].limit = MAX_PULSES;
+                    pStrand->_rmtPulses = _blocks[pStrand->_rmtChannel] * MAX_PULSES;
 
                     // RMT config for transmitting a '0' bit val to this LED strand
-                    pStrand->_rmtPulsePair[0].level0 = 1;
-                    pStrand->_rmtPulsePair[0].level1 = 0;
-                    pStrand->_rmtPulsePair[0].duration0 = ledParams.T0H / (RMT_DURATION_NS * DIVIDER);
-                    pStrand->_rmtPulsePair[0].duration1 = ledParams.T0L / (RMT_DURATION_NS * DIVIDER);
+                    pulse[0].level0 = 1;
+                    pulse[0].level1 = 0;
+                    pulse[0].duration0 = ledParams.T0H / (RMT_DURATION_NS * DIVIDER);
+                    pulse[0].duration1 = ledParams.T0L / (RMT_DURATION_NS * DIVIDER);
 
-                    // RMT config for transmitting a '0' bit val to this LED strand
-                    pStrand->_rmtPulsePair[1].level0 = 1;
-                    pStrand->_rmtPulsePair[1].level1 = 0;
-                    pStrand->_rmtPulsePair[1].duration0 = ledParams.T1H / (RMT_DURATION_NS * DIVIDER);
-                    pStrand->_rmtPulsePair[1].duration1 = ledParams.T1L / (RMT_DURATION_NS * DIVIDER);
+                    // RMT config for transmitting a '1' bit val to this LED strand
+                    pulse[1].level0 = 1;
+                    pulse[1].level1 = 0;
+                    pulse[1].duration0 = ledParams.T1H / (RMT_DURATION_NS * DIVIDER);
+                    pulse[1].duration1 = ledParams.T1L / (RMT_DURATION_NS * DIVIDER);
 
-                    RMT.int_ena.val |=
-                        __tx_thr_event_offsets[pStrand->_rmtChannel];          // RMT.int_ena.ch<n>_tx_thr_event = 1;
-                    RMT.int_ena.val |= __tx_end_offsets[pStrand->_rmtChannel]; // RMT.int_ena.ch<n>_tx_end = 1;
+                    PIXEL::rmtTable(pStrand->_rmtTable, pulse[0].val, pulse[1].val);
+                    pStrand->_rmtReset = ledParams.TRS / (RMT_DURATION_NS * DIVIDER);
 
                     pStrand->clear();
                 }
 
-                esp_intr_alloc(ETS_RMT_INTR_SOURCE, 0, __rmtInterrupt, this, &this->_rmt_intr_handle);
+                if (!_rmt_intr_handle)
+                    esp_intr_alloc(ETS_RMT_INTR_SOURCE, 0, __rmtInterrupt, this, &this->_rmt_intr_handle);
                 _started = true;
 
                 render();
@@ -286,19 +500,198 @@ namespace EZ
             {
                 if (!_started)
                     return;
+
+                wait();
+
+                if (_rmt_intr_handle)
+                {
+                    esp_intr_free(_rmt_intr_handle);
+                    _rmt_intr_handle = NULL;
+                }
+
                 _started = false;
             }
 
         protected:
             void _initialise()
             {
+                _strands = nullptr;
+                _strandCount = 0;
                 _started = false;
                 _rmt_intr_handle = NULL;
+                _budget = FRAME_BUDGET;
+                _framePending = 0;
+                _frameStart = _frameTime = 0;
+
+                for (int c = 0; c < MAX_CHANNELS; c++)
+                {
+                    _blocks[c] = 0;
+                    _active[c] = nullptr;
+                }
+            }
+
+            // Output a dirty strand into its back buffer, true if it's to be sent
+            //
+            bool _output(STRAND* pStrand)
+            {
+                pStrand->_rmtQueued = false;
 
-                for (int s = 0; s < MAX_STRANDS; s++)
+                if (pStrand->_isDirty && pStrand->_rmtChannel < MAX_CHANNELS && pStrand->_rmtSemaphore)
                 {
-                    if (_strands[s])
-                        _strands[s]->_neoRender = this;
+                    pStrand->_isDirty = false;
+
+                    if (!(pStrand->_rmtQueued = (pStrand->output() != nullptr)))
+                        pStrand->_isDirty = true;
+                }
+
+                return pStrand->_rmtQueued;
+            }
+
+            // Swap the (idle) front buffer for the freshly output back buffer
+            //
+            void _swap(STRAND* pStrand, bool frame)
+            {
+                uint8_t* data = pStrand->_wireData;
+
+                xSemaphoreTake(pStrand->_rmtSemaphore, portMAX_DELAY);
+
+                pStrand->_wireData = pStrand->_rmtData; // nullptr first time round, output() allocates
+                pStrand->_rmtData = data;
+                pStrand->_rmtNext = nullptr;
+                pStrand->_rmtFrame = frame;
+                pStrand->_rmtBusy = true;
+            }
+
+            inline void _start(STRAND* pStrand, uint32_t now)
+            {
+                pStrand->_rmtStart = now;
+                RMT.conf_ch[pStrand->_rmtChannel].conf1.tx_start = 1;
+            }
+
+            // Estimated time (us) to send a strand
+            //
+            uint32_t _estimate(STRAND* pStrand)
+            {
+                neo_params_t ledParams = __neoParams[pStrand->_neoType];
+                uint32_t bit = max(ledParams.T0H + ledParams.T0L, ledParams.T1H + ledParams.T1L);
+
+                return ((uint64_t)pStrand->_pixelBytes * 8 * bit + ledParams.TRS) / 1000;
+            }
+
+            // Blocks free from (and including) a claimed channel, up to the number wanted
+            //
+            uint8_t _freeBlocks(const bool* used, int channel, int want)
+            {
+                int blocks = 1;
+
+                while (blocks < want && channel + blocks < MAX_CHANNELS && !used[channel + blocks])
+                    blocks++;
+
+                return blocks;
+            }
+
+            void _allocate(void)
+            {
+                bool used[MAX_CHANNELS] = {false};
+                uint32_t load[MAX_CHANNELS] = {0};
+                uint16_t count[MAX_CHANNELS] = {0};
+
+                for (int c = 0; c < MAX_CHANNELS; c++)
+                    _blocks[c] = 0;
+
+                // Requested channels first...
+                for (int s = 0; s < _strandCount; s++)
+                {
+                    STRAND* pStrand = _strands[s];
+
+                    pStrand->_rmtChannel = RMT_CHANNEL_MAX;
+                    pStrand->_rmtShared = false;
+
+                    if (pStrand->_rmtWant < MAX_CHANNELS)
+                    {
+                        if (used[pStrand->_rmtWant])
+                            ESP_LOGW(iotTag, "NEO: channel %d already taken, allocating another", pStrand->_rmtWant);
+                        else
+                            used[pStrand->_rmtChannel = pStrand->_rmtWant] = true;
+                    }
+                }
+
+                // ...given what memory they can have, before the rest get a channel
+                for (int pass = 0; pass < 2; pass++)
+                {
+                    for (int s = 0; s < _strandCount; s++)
+                    {
+                        STRAND* pStrand = _strands[s];
+                        int channel = pStrand->_rmtChannel;
+                        int want = constrain(pStrand->_rmtBlocks, 1, MAX_BLOCKS);
+
+                        if ((pass == 0) != (channel < MAX_CHANNELS))
+                            continue;
+
+                        if (pass)
+                        {
+                            int blocks = 0;
+
+                            for (int c = 0; c < MAX_CHANNELS && blocks < want; c++)
+                            {
+                                if (!used[c] && _freeBlocks(used, c, want) > blocks)
+                                    blocks = _freeBlocks(used, channel = c, want);
+                            }
+
+                            if (!blocks)
+                            {
+                                // Out of channels, share the least loaded
+                                for (int c = 0; c < MAX_CHANNELS; c++)
+                                {
+                                    if (_blocks[c] && (!blocks || load[c] < load[channel]))
+                                        blocks = _blocks[channel = c];
+                                }
+
+                                if (!blocks)
+                                {
+                                    ESP_LOGE(iotTag, "NEO: no RMT channel for strand on gpio %d", pStrand->_rmtPin);
+                                    continue;
+                                }
+                            }
+                        }
+
+                        if (!_blocks[channel])
+                        {
+                            _blocks[channel] = _freeBlocks(used, channel, want);
+
+                            for (int b = 0; b < _blocks[channel]; b++)
+                                used[channel + b] = true;
+
+                            if (_blocks[channel] != want)
+                                ESP_LOGW(iotTag, "NEO: channel %d limited to %d memory block(s)", channel,
+                                         _blocks[channel]);
+                        }
+
+                        pStrand->_rmtChannel = (rmt_channel_t)channel;
+                        load[channel] += _estimate(pStrand);
+                        count[channel]++;
+                    }
+                }
+
+                for (int s = 0; s < _strandCount; s++)
+                {
+                    STRAND* pStrand = _strands[s];
+
+                    if (pStrand->_rmtChannel < MAX_CHANNELS)
+                    {
+                        pStrand->_rmtShared = count[pStrand->_rmtChannel] > 1;
+
+                        ESP_LOGI(iotTag, "NEO: gpio %d on channel %d (%d blocks%s) ~%u us", pStrand->_rmtPin,
+                                 pStrand->_rmtChannel, _blocks[pStrand->_rmtChannel],
+                                 pStrand->_rmtShared ? ", shared" : "", _estimate(pStrand));
+                    }
+                }
+
+                for (int c = 0; c < MAX_CHANNELS; c++)
+                {
+                    if (load[c] > _budget)
+                        ESP_LOGW(iotTag, "NEO: channel %d needs ~%u us, over the %u us frame budget", c, load[c],
+                                 _budget);
                 }
             }
 
@@ -306,9 +699,16 @@ namespace EZ
             DRIVER(DRIVER const& copy);            // Not Implemented
             DRIVER& operator=(DRIVER const& copy); // Not Implemented
 
-            STRAND* _strands[MAX_STRANDS];
+            STRAND** _strands;
+            uint16_t _strandCount;
+            uint8_t _blocks[MAX_CHANNELS];          // Memory blocks of each channel in use
+            STRAND* volatile _active[MAX_CHANNELS]; // Strand being sent on each channel
             bool _started;
             intr_handle_t _rmt_intr_handle;
+            uint32_t _budget;
+            volatile uint16_t _framePending;
+            volatile uint32_t _frameStart;
+            volatile uint32_t _frameTime;
         };
 
         // This fills half an RMT block
@@ -316,16 +716,15 @@ namespace EZ
         //
         IRAM_ATTR void __rmtCopyBlock(STRAND* pStrand)
         {
-            neo_params_t ledParams = __neoParams[pStrand->_neoType];
-            uint16_t i, j, offset, len, byteval;
+            uint16_t i, len, pulses = pStrand->_rmtPulses;
+            volatile uint32_t* mem = &RMTMEM.chan[pStrand->_rmtChannel].data32[0].val + pStrand->_rmtHalf * pulses;
 
-            offset = pStrand->_rmtHalf * MAX_PULSES;
             pStrand->_rmtHalf = !pStrand->_rmtHalf;
 
             len = pStrand->_pixelBytes - pStrand->_rmtIndex;
 
-            if (len > (MAX_PULSES / 8))
-                len = (MAX_PULSES / 8);
+            if (len > (pulses / 8))
+                len = (pulses / 8);
 
             if (!len)
             {
@@ -335,46 +734,55 @@ namespace EZ
                 }
 
                 // Clear the channel's data block and return
-                for (i = 0; i < MAX_PULSES; i++)
+                for (i = 0; i < pulses; i++)
                 {
-                    RMTMEM.chan[pStrand->_rmtChannel].data32[i + offset].val = 0;
+                    mem[i] = 0;
                 }
 
-                pStrand->_rmtDirty = pStrand->_isDirty = 0;
+                pStrand->_rmtDirty = 0;
                 return;
             }
 
             pStrand->_rmtDirty = 1;
 
-            for (i = 0; i < len; i++)
-            {
-                byteval = pStrand->_pixelData[i + pStrand->_rmtIndex];
-
-                // Shift bits out, MSB first, setting RMTMEM.chan[n].data32[x] to
-                // the rmtPulsePair value corresponding to the buffered bit value
-                for (j = 0; j < 8; j++, byteval <<= 1)
-                {
-                    int bitval = (byteval >> 7) & 0x01;
-                    int data32_idx = i * 8 + offset + j;
+            PIXEL::rmtEncode(mem, &pStrand->_rmtData[pStrand->_rmtIndex], len, pStrand->_rmtTable);
+            pStrand->_rmtIndex += len;
 
-                    RMTMEM.chan[pStrand->_rmtChannel].data32[data32_idx].val = pStrand->_rmtPulsePair[bitval].val;
-                }
+            // Handle the reset bit by stretching duration1 for the final bit in the stream
+            if (pStrand->_rmtIndex == pStrand->_pixelBytes)
+            {
+                STRAND::rmt_pulse_t last;
 
-                // Handle the reset bit by stretching duration1 for the final bit in the stream
-                if (i + pStrand->_rmtIndex == pStrand->_pixelBytes - 1)
-                {
-                    RMTMEM.chan[pStrand->_rmtChannel].data32[i * 8 + offset + 7].duration1 =
-                        ledParams.TRS / (RMT_DURATION_NS * DIVIDER);
-                }
+                last.val = mem[len * 8 - 1];
+                last.duration1 = pStrand->_rmtReset;
+                mem[len * 8 - 1] = last.val;
             }
 
             // Clear the remainder of the channel's data not set above
-            for (i *= 8; i < MAX_PULSES; i++)
+            for (i = len * 8; i < pulses; i++)
             {
-                RMTMEM.chan[pStrand->_rmtChannel].data32[i + offset].val = 0;
+                mem[i] = 0;
             }
+        }
 
-            pStrand->_rmtIndex += len;
+        // Make a strand the active one on its channel and fill the channel memory ready to go
+        //
+        IRAM_ATTR void __rmtLoad(DRIVER* pDriver, STRAND* pStrand)
+        {
+            pDriver->_active[pStrand->_rmtChannel] = pStrand;
+
+            pStrand->_rmtIndex = 0;
+            pStrand->_rmtHalf = 0;
+            pStrand->_rmtDirty = 1;
+
+            __rmtCopyBlock(pStrand);
+            if (pStrand->_rmtIndex < pStrand->_pixelBytes)
+                __rmtCopyBlock(pStrand);
+
+            if (pStrand->_rmtShared)
+                gpio_matrix_out(pStrand->_rmtPin, RMT_SIG_OUT0_IDX + pStrand->_rmtChannel, false, false);
+
+            RMT.conf_ch[pStrand->_rmtChannel].conf1.mem_rd_rst = 1;
         }
 
         IRAM_ATTR void __rmtInterrupt(void* arg)
@@ -382,29 +790,55 @@ namespace EZ
             portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
             DRIVER* pDriver = (DRIVER*)arg;
 
-            for (int s = 0; s < MAX_STRANDS; s++)
+            for (int c = 0; c < MAX_CHANNELS; c++)
             {
-                STRAND* pStrand = pDriver->_strands[s];
+                STRAND* pStrand = pDriver->_active[c];
 
                 if (pStrand)
                 {
-                    if (RMT.int_st.val & __tx_thr_event_offsets[pStrand->_rmtChannel])
+                    if (RMT.int_st.val & __tx_thr_event_offsets[c])
                     {
                         __rmtCopyBlock(pStrand);
-                        RMT.int_clr.val |= __tx_thr_event_offsets[pStrand->_rmtChannel];
+                        RMT.int_clr.val |= __tx_thr_event_offsets[c];
                     }
-                    else if (RMT.int_st.val & __tx_end_offsets[pStrand->_rmtChannel] && pStrand->_rmtSemaphore)
+                    else if (RMT.int_st.val & __tx_end_offsets[c] && pStrand->_rmtSemaphore)
                     {
-                        xSemaphoreGiveFromISR(pStrand->_rmtSemaphore, &xHigherPriorityTaskWoken);
-                        RMT.int_clr.val |= __tx_end_offsets[pStrand->_rmtChannel];
+                        uint32_t now = micros();
+                        STRAND* pNext = pStrand->_rmtNext;
 
-                        if (xHigherPriorityTaskWoken == pdTRUE)
+                        RMT.int_clr.val |= __tx_end_offsets[c];
+
+                        pStrand->_rmtTime = now - pStrand->_rmtStart;
+                        pStrand->_rmtLatency = pStrand->_rmtFrame ? now - pDriver->_frameStart : pStrand->_rmtTime;
+                        pStrand->_rmtNext = nullptr;
+
+                        if (pStrand->_rmtFrame && pDriver->_framePending && --pDriver->_framePending == 0)
+                            pDriver->_frameTime = now - pDriver->_frameStart;
+
+                        // Hand a shared channel on to the next strand
+                        if (pStrand->_rmtShared)
+                            gpio_matrix_out(pStrand->_rmtPin, SIG_GPIO_OUT_IDX, false, false);
+
+                        if (pNext)
                         {
-                            portYIELD_FROM_ISR();
+                            __rmtLoad(pDriver, pNext);
+                            pNext->_rmtStart = now;
+                            RMT.conf_ch[c].conf1.tx_start = 1;
                         }
+
+                        pStrand->_rmtBusy = false;
+                        xSemaphoreGiveFromISR(pStrand->_rmtSemaphore, &xHigherPriorityTaskWoken);
+
+                        if (pStrand->_rmtNotify)
+                            vTaskNotifyGiveFromISR(pStrand->_rmtNotify, &xHigherPriorityTaskWoken);
                     }
                 }
             }
+
+            if (xHigherPriorityTaskWoken == pdTRUE)
+            {
+                portYIELD_FROM_ISR();
+            }
         }
     } // namespace NEO
 } // namespace EZ
@@ -0,0 +1,372 @@
+/*
+** EZIoT - NEO Pixels: Parallel (I2S) Output
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_HAL_NEO_I2S_H
+#define _EZ_HAL_NEO_I2S_H
+#include "hal_neo.h"
+#include "pixel/pixel_transpose.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if defined(ARDUINO)
+#include "driver/periph_ctrl.h"
+#include "esp_heap_caps.h"
+#include "rom/lldesc.h"
+#include "soc/i2s_struct.h"
+#elif defined(ESP_PLATFORM)
+#include <driver/periph_ctrl.h>
+#include <esp_heap_caps.h>
+#include <rom/lldesc.h>
+#include <soc/i2s_struct.h>
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+namespace EZ
+{
+    namespace NEO
+    {
+        static IRAM_ATTR void __i2sInterrupt(void* arg);
+
+        // Samples are clocked at 3x the 800KHz bit rate (high / data / low)
+        static const uint32_t I2S_SAMPLE_HZ = 2400000;
+        // I2S clock source (PLL_D2), LCD mode takes two clocks per sample
+        static const uint32_t I2S_BASE_HZ = 160000000;
+        // Zero samples after the data to latch the strands (> 80us)
+        static const uint16_t I2S_RESET_SAMPLES = 200;
+        // Largest single DMA descriptor
+        static const uint16_t I2S_DMA_MAX = 4092;
+
+        /*
+        ** PARALLEL - Renders up to 16 strands at once over I2S1 in 16-bit LCD mode
+        **
+        ** Strand n is driven by data line n, the strands' byte streams being transposed into
+        ** bit planes (see pixel_transpose.h) so the whole frame is a single DMA transfer, no
+        ** matter how many strands. The strands' RMT channels are unused, and the timing is the
+        ** 800KHz WS281x/SK6812 shape whatever their type.
+        **
+        ** The DMA buffer is 48 bytes per byte of the longest strand.
+        */
+        class PARALLEL : public RENDER
+        {
+        public:
+            friend IRAM_ATTR void __i2sInterrupt(void* arg);
+
+            template<class... _S> PARALLEL(STRAND& s1, _S&... sn)
+                : _strandCount(0), _dmaBuffer(nullptr), _dmaDesc(nullptr), _dmaSize(0), _descCount(0),
+                  _semaphore(nullptr), _intr(NULL), _started(false), _busy(false), _frameStart(0), _frameTime(0)
+            {
+                for (STRAND* pStrand : {&s1, &sn...})
+                {
+                    if (_strandCount < PIXEL::MAX_LANES)
+                    {
+                        _strands[_strandCount++] = pStrand;
+                        pStrand->_neoRender = this;
+                    }
+                    else
+                        ESP_LOGE(iotTag, "NEO: parallel output is limited to %d strands", PIXEL::MAX_LANES);
+                }
+            }
+
+            ~PARALLEL()
+            {
+                stop();
+
+                if (_dmaBuffer)
+                    heap_caps_free(_dmaBuffer);
+                if (_dmaDesc)
+                    heap_caps_free(_dmaDesc);
+                if (_semaphore)
+                    vSemaphoreDelete(_semaphore);
+            }
+
+            // All strands go out together, so a strand render sends the lot
+            //
+            void render(STRAND* pStrand) { render(); }
+
+            void render(void)
+            {
+                const uint8_t* data[PIXEL::MAX_LANES];
+                size_t count[PIXEL::MAX_LANES];
+                bool dirty = false;
+
+                if (!_started)
+                    return;
+
+                for (int s = 0; s < _strandCount; s++)
+                    dirty |= _strands[s]->_isDirty;
+
+                if (!dirty)
+                    return;
+
+                // The DMA buffer is being sent until the last frame is done
+                wait();
+
+                for (int s = 0; s < _strandCount; s++)
+                {
+                    STRAND* pStrand = _strands[s];
+
+                    pStrand->_isDirty = false;
+                    data[s] = pStrand->output();
+                    count[s] = data[s] ? pStrand->_pixelBytes : 0;
+                }
+
+                PIXEL::encodeParallel(_dmaBuffer, data, count, _strandCount, _maxBytes, _mask);
+
+                xSemaphoreTake(_semaphore, portMAX_DELAY);
+                _busy = true;
+                _send();
+            }
+
+            bool wait(TickType_t timeout = portMAX_DELAY)
+            {
+                if (!_semaphore || !_busy)
+                    return true;
+
+                if (xSemaphoreTake(_semaphore, timeout) != pdTRUE)
+                    return false;
+
+                xSemaphoreGive(_semaphore);
+                return true;
+            }
+
+            bool busy(void) { return _busy; }
+
+            // Duration (us) of the last frame
+            //
+            uint32_t frameTime(void) { return _frameTime; }
+
+            bool start(void)
+            {
+                size_t samples;
+
+                if (_started)
+                    stop();
+
+                _maxBytes = 0;
+                _mask = 0;
+
+                for (int s = 0; s < _strandCount; s++)
+                {
+                    _maxBytes = max(_maxBytes, _strands[s]->_pixelBytes);
+                    _mask |= (1 << s);
+                }
+
+                samples = _maxBytes * 24 + I2S_RESET_SAMPLES;
+
+                if (!_alloc(samples * sizeof(uint16_t)))
+                {
+                    ESP_LOGE(iotTag, "NEO: no DMA memory for %u parallel samples", (unsigned)samples);
+                    return false;
+                }
+
+                if (!_semaphore && (_semaphore = xSemaphoreCreateBinary()))
+                    xSemaphoreGive(_semaphore);
+
+                _i2sInit();
+
+                for (int s = 0; s < _strandCount; s++)
+                {
+                    gpio_pad_select_gpio(_strands[s]->_rmtPin);
+                    gpio_set_direction(_strands[s]->_rmtPin, GPIO_MODE_OUTPUT);
+                    gpio_matrix_out(_strands[s]->_rmtPin, I2S1O_DATA_OUT8_IDX + s, false, false);
+                    _strands[s]->clear();
+                }
+
+                if (!_intr)
+                    esp_intr_alloc(ETS_I2S1_INTR_SOURCE, 0, __i2sInterrupt, this, &_intr);
+
+                _started = true;
+                render();
+                return true;
+            }
+
+            void stop(void)
+            {
+                if (!_started)
+                    return;
+
+                wait();
+
+                if (_intr)
+                {
+                    esp_intr_free(_intr);
+                    _intr = NULL;
+                }
+
+                _started = false;
+            }
+
+        protected:
+            // DMA buffer (zeroed, so the reset tail is in place) and its descriptor chain
+            //
+            bool _alloc(size_t size)
+            {
+                size = (size + 3) & ~3;
+
+                if (_dmaBuffer && size == _dmaSize)
+                    return true;
+
+                if (_dmaBuffer)
+                    heap_caps_free(_dmaBuffer);
+                if (_dmaDesc)
+                    heap_caps_free(_dmaDesc);
+
+                _descCount = (size + I2S_DMA_MAX - 1) / I2S_DMA_MAX;
+                _dmaBuffer = (uint16_t*)heap_caps_calloc(1, size, MALLOC_CAP_DMA);
+                _dmaDesc = (lldesc_t*)heap_caps_calloc(_descCount, sizeof(lldesc_t), MALLOC_CAP_DMA);
+
+                if (!_dmaBuffer || !_dmaDesc)
+                {
+                    _dmaSize = 0;
+                    return false;
+                }
+
+                for (int d = 0; d < _descCount; d++)
+                {
+                    size_t offset = d * I2S_DMA_MAX;
+                    size_t length = min(size - offset, (size_t)I2S_DMA_MAX);
+
+                    _dmaDesc[d].owner = 1;
+                    _dmaDesc[d].eof = (d == _descCount - 1);
+                    _dmaDesc[d].sosf = 0;
+                    _dmaDesc[d].length = length;
+                    _dmaDesc[d].size = length;
+                    _dmaDesc[d].buf = (uint8_t*)_dmaBuffer + offset;
+                    _dmaDesc[d].qe.stqe_next = (d == _descCount - 1) ? nullptr : &_dmaDesc[d + 1];
+                }
+
+                _dmaSize = size;
+                return true;
+            }
+
+            void _i2sInit(void)
+            {
+                // Sample clock = base / (num + b / a) / 2
+                uint32_t div = (I2S_BASE_HZ / 2) * 3 / I2S_SAMPLE_HZ;
+
+                periph_module_enable(PERIPH_I2S1_MODULE);
+
+                I2S1.conf.tx_reset = 1;
+                I2S1.conf.tx_reset = 0;
+                I2S1.conf.tx_fifo_reset = 1;
+                I2S1.conf.tx_fifo_reset = 0;
+                I2S1.lc_conf.out_rst = 1;
+                I2S1.lc_conf.out_rst = 0;
+                I2S1.lc_conf.ahbm_rst = 1;
+                I2S1.lc_conf.ahbm_rst = 0;
+
+                I2S1.conf2.val = 0;
+                I2S1.conf2.lcd_en = 1;
+
+                I2S1.clkm_conf.val = 0;
+                I2S1.clkm_conf.clka_en = 0;
+                I2S1.clkm_conf.clkm_div_num = div / 3;
+                I2S1.clkm_conf.clkm_div_b = div % 3;
+                I2S1.clkm_conf.clkm_div_a = 3;
+
+                I2S1.sample_rate_conf.val = 0;
+                I2S1.sample_rate_conf.tx_bits_mod = 16;
+                I2S1.sample_rate_conf.tx_bck_div_num = 1;
+
+                I2S1.fifo_conf.val = 0;
+                I2S1.fifo_conf.tx_fifo_mod_force_en = 1;
+                I2S1.fifo_conf.tx_fifo_mod = 1; // 16-bit single channel
+                I2S1.fifo_conf.tx_data_num = 32;
+                I2S1.fifo_conf.dscr_en = 1;
+
+                I2S1.conf1.val = 0;
+                I2S1.conf1.tx_stop_en = 0;
+                I2S1.conf1.tx_pcm_bypass = 1;
+
+                I2S1.conf_chan.val = 0;
+                I2S1.conf_chan.tx_chan_mod = 1;
+
+                I2S1.conf.tx_right_first = 1;
+                I2S1.timing.val = 0;
+
+                I2S1.int_ena.val = 0;
+                I2S1.int_clr.val = I2S1.int_raw.val;
+                I2S1.int_ena.out_eof = 1;
+            }
+
+            void _send(void)
+            {
+                I2S1.conf.tx_start = 0;
+                I2S1.conf.tx_reset = 1;
+                I2S1.conf.tx_reset = 0;
+                I2S1.conf.tx_fifo_reset = 1;
+                I2S1.conf.tx_fifo_reset = 0;
+                I2S1.lc_conf.out_rst = 1;
+                I2S1.lc_conf.out_rst = 0;
+
+                I2S1.lc_conf.out_data_burst_en = 1;
+                I2S1.lc_conf.outdscr_burst_en = 1;
+                I2S1.out_link.addr = (uint32_t)&_dmaDesc[0];
+                I2S1.out_link.start = 1;
+
+                _frameStart = micros();
+                I2S1.conf.tx_start = 1;
+            }
+
+        private:
+            PARALLEL(PARALLEL const& copy);            // Not Implemented
+            PARALLEL& operator=(PARALLEL const& copy); // Not Implemented
+
+            STRAND* _strands[PIXEL::MAX_LANES];
+            uint8_t _strandCount;
+            uint16_t _mask;
+            size_t _maxBytes;
+            uint16_t* _dmaBuffer;
+            lldesc_t* _dmaDesc;
+            size_t _dmaSize;
+            int _descCount;
+            xSemaphoreHandle _semaphore;
+            intr_handle_t _intr;
+            bool _started;
+            volatile bool _busy;
+            volatile uint32_t _frameStart;
+            volatile uint32_t _frameTime;
+        };
+
+        IRAM_ATTR void __i2sInterrupt(void* arg)
+        {
+            portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+            PARALLEL* pParallel = (PARALLEL*)arg;
+
+            if (I2S1.int_st.out_eof)
+            {
+                // The FIFO still has the tail of the reset to clock out, which is all zeros
+                I2S1.conf.tx_start = 0;
+                I2S1.out_link.stop = 1;
+
+                pParallel->_frameTime = micros() - pParallel->_frameStart;
+                pParallel->_busy = false;
+                xSemaphoreGiveFromISR(pParallel->_semaphore, &xHigherPriorityTaskWoken);
+            }
+
+            I2S1.int_clr.val = I2S1.int_st.val;
+
+            if (xHigherPriorityTaskWoken == pdTRUE)
+            {
+                portYIELD_FROM_ISR();
+            }
+        }
+    } // namespace NEO
+} // namespace EZ
+#endif // _EZ_HAL_NEO_I2S_H
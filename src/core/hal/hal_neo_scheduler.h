@@ -0,0 +1,286 @@
+/*
+** EZIoT - Pixel Frame Scheduler
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_HAL_NEO_SCHEDULER_H
+#define _EZ_HAL_NEO_SCHEDULER_H
+#include "hal_neo.h"
+#include "pixel/pixel_commands.h"
+
+namespace EZ
+{
+    namespace NEO
+    {
+        static const uint32_t SCHEDULER_IDLE = 100;    // ms, longest sleep (picks up handlers turned on)
+        static const uint32_t SCHEDULER_WINDOW = 1000; // ms, fps / jitter measurement period
+
+        /*
+        ** SCHEDULER - Runs handlers from a task of its own instead of loop()
+        **
+        ** Handlers are kept in a min-heap on their next frame deadline, the task sleeps until the
+        ** earliest, services every handler due by then and renders them all with one call to the
+        ** RENDER (DRIVER or PARALLEL). Deadlines are compared as signed differences, so survive
+        ** millis() rolling over.
+        **
+        ** NEO::DRIVER neo(strand1, strand2);
+        ** NEO::SCHEDULER sched(neo);
+        **
+        ** sched.add(strand1); sched.add(strand2); neo.start(); sched.start();
+        **
+        ** Control from other tasks should go through a PIXEL::COMMANDS queue given to commands(),
+        ** it is applied between frames. Queued changes are picked up within SCHEDULER_IDLE ms,
+        ** call wake() after queueing to have them picked up at once.
+        */
+        class SCHEDULER
+        {
+        public:
+            SCHEDULER(RENDER& render, BaseType_t core = 1, UBaseType_t priority = 2)
+                : _render(&render), _core(core), _priority(priority), _heap(nullptr), _count(0), _commands(nullptr),
+                  _task(nullptr), _running(false), _fps(0), _jitter(0), _jitterMax(0)
+            {
+                _resetStats(millis());
+            }
+
+            ~SCHEDULER()
+            {
+                stop();
+
+                if (_heap)
+                    free(_heap);
+            }
+
+            // Add a handler, before start()
+            //
+            bool add(PIXEL::HANDLER& handler)
+            {
+                entry_t* heap;
+
+                if (_task || !(heap = (entry_t*)realloc(_heap, (_count + 1) * sizeof(entry_t))))
+                    return false;
+
+                _heap = heap;
+                _heap[_count].handler = &handler;
+                _heap[_count].due = handler.due();
+                _up(_count++);
+                return true;
+            }
+
+            // Queue to apply between frames, before start()
+            //
+            void commands(PIXEL::COMMANDS& queue)
+            {
+                if (!_task)
+                    _commands = &queue;
+            }
+
+            bool start(void)
+            {
+                if (_task)
+                    return true;
+
+                TaskHandle_t task = nullptr;
+
+                _running = true;
+                xTaskCreatePinnedToCore(_schedulerTask, "neoSched", 4096, this, _priority, &task, _core);
+
+                if (!(_task = task))
+                {
+                    _running = false;
+                    ESP_LOGE(iotTag, "NEO: failed to create scheduler task");
+                    return false;
+                }
+
+                return true;
+            }
+
+            void stop(void)
+            {
+                if (!_task)
+                    return;
+
+                _running = false;
+                wake();
+
+                while (_task)
+                    vTaskDelay(1);
+            }
+
+            // Re-read every deadline now, rather than when each handler is next due
+            //
+            void wake(void)
+            {
+                TaskHandle_t task = _task;
+
+                if (task)
+                    xTaskNotifyGive(task);
+            }
+
+            // Renders per second, and how late (us) frames started after their deadline, the mean
+            // and worst over the last SCHEDULER_WINDOW
+            //
+            float fps(void) { return _fps; }
+            uint32_t jitter(void) { return _jitter; }
+            uint32_t jitterMax(void) { return _jitterMax; }
+
+        protected:
+            typedef struct
+            {
+                uint32_t due; // millis()
+                PIXEL::HANDLER* handler;
+            } entry_t;
+
+            RENDER* _render;
+            BaseType_t _core;
+            UBaseType_t _priority;
+            entry_t* _heap;
+            uint16_t _count;
+            PIXEL::COMMANDS* _commands;
+            volatile TaskHandle_t _task;
+            volatile bool _running;
+
+            uint32_t _windowStart;
+            uint32_t _frames;
+            uint64_t _lateSum;
+            uint32_t _lateMax;
+            float _fps;
+            uint32_t _jitter;
+            uint32_t _jitterMax;
+
+            static void _schedulerTask(void* pv)
+            {
+                SCHEDULER* sched = (SCHEDULER*)pv;
+
+                while (sched->_running)
+                    sched->_loop();
+
+                sched->_task = nullptr;
+                vTaskDelete(NULL);
+            }
+
+            void _loop(void)
+            {
+                // Frame boundary, nothing is mid-frame
+                if (_commands && _commands->apply())
+                    _rebuild();
+
+                uint32_t now = millis();
+                int32_t wait = _count ? (int32_t)(_heap[0].due - now) : SCHEDULER_IDLE;
+
+                if (wait > 0)
+                {
+                    // A notification (wake()) cuts the sleep short, then every deadline is re-read
+                    TickType_t ticks = ((uint32_t)wait < SCHEDULER_IDLE ? (uint32_t)wait : SCHEDULER_IDLE) / portTICK_PERIOD_MS;
+
+                    if (ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1))
+                        _rebuild();
+                    return;
+                }
+
+                // Everything due this tick goes into one render
+                int32_t behind = (int32_t)(micros() - _heap[0].due * 1000);
+                uint32_t late = behind > 0 ? behind : 0;
+                bool frame = false;
+
+                while (_count && (int32_t)(_heap[0].due - now) <= 0)
+                {
+                    PIXEL::HANDLER* handler = _heap[0].handler;
+
+                    frame |= handler->service();
+                    _heap[0].due = handler->running() ? handler->due() : now + SCHEDULER_IDLE;
+
+                    // Don't spin on a handler whose deadline didn't move
+                    if ((int32_t)(_heap[0].due - now) <= 0)
+                        _heap[0].due = now + 1;
+                    _down(0);
+                }
+
+                if (frame)
+                {
+                    _render->render();
+                    _frames++;
+                    _lateSum += late;
+                    if (late > _lateMax)
+                        _lateMax = late;
+                }
+
+                if ((now - _windowStart) >= SCHEDULER_WINDOW)
+                {
+                    _fps = (_frames * 1000.0f) / (now - _windowStart);
+                    _jitter = _frames ? _lateSum / _frames : 0;
+                    _jitterMax = _lateMax;
+                    _resetStats(now);
+                }
+            }
+
+            void _resetStats(uint32_t now)
+            {
+                _windowStart = now;
+                _frames = 0;
+                _lateSum = 0;
+                _lateMax = 0;
+            }
+
+            // Min-heap on due, compared as signed differences
+            //
+            bool _before(uint16_t a, uint16_t b) { return (int32_t)(_heap[a].due - _heap[b].due) < 0; }
+
+            void _swap(uint16_t a, uint16_t b)
+            {
+                entry_t t = _heap[a];
+
+                _heap[a] = _heap[b];
+                _heap[b] = t;
+            }
+
+            void _up(uint16_t n)
+            {
+                for (uint16_t parent; n && _before(n, (parent = (n - 1) / 2)); n = parent)
+                    _swap(n, parent);
+            }
+
+            void _down(uint16_t n)
+            {
+                for (;;)
+                {
+                    uint16_t least = n;
+                    uint16_t child = 2 * n + 1;
+
+                    if (child < _count && _before(child, least))
+                        least = child;
+                    if (child + 1 < _count && _before(child + 1, least))
+                        least = child + 1;
+                    if (least == n)
+                        break;
+
+                    _swap(n, least);
+                    n = least;
+                }
+            }
+
+            void _rebuild(void)
+            {
+                uint32_t now = millis();
+
+                for (uint16_t n = 0; n < _count; n++)
+                    _heap[n].due = _heap[n].handler->running() ? _heap[n].handler->due() : now + SCHEDULER_IDLE;
+
+                for (uint16_t n = _count / 2; n-- > 0;)
+                    _down(n);
+            }
+
+        private:
+            SCHEDULER(SCHEDULER const& copy);            // Not Implemented
+            SCHEDULER& operator=(SCHEDULER const& copy); // Not Implemented
+        };
+    } // namespace NEO
+} // namespace EZ
+#endif // _EZ_HAL_NEO_SCHEDULER_H
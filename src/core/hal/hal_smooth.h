@@ -17,15 +17,32 @@
 #ifndef _EZ_HAL_SMOOTH_H
 #define _EZ_HAL_SMOOTH_H
 #include <Arduino.h>
+#include <limits>
+#include <type_traits>
 
 namespace EZ
 {
     namespace HAL
     {
+        /*
+        ** Accumulator for a sample type: 32 bits for 16 bit and smaller integers, 64 bits
+        ** for wider ones, floats as themselves. 8 bit and int16_t samples fit any window,
+        ** uint16_t only windows up to 32768 (pass an int64_t _S for a longer one) and 64 bit
+        ** samples none. AVERAGE checks this at compile time.
+        */
+        template<class _T>
+        using ACCUMULATOR = typename std::conditional<
+            std::is_integral<_T>::value,
+            typename std::conditional<(sizeof(_T) <= 2), int32_t, int64_t>::type, _T>::type;
+
+        /*
+        ** SMOOTH - Moving average over a run time window (1..100), kept as a running sum so
+        ** each sample is O(1). Until the window fills, averages the readings seen so far.
+        */
         template<class _T> class SMOOTH
         {
         public:
-            SMOOTH(uint16_t numReadings = 10) : _nxtReading(0)
+            SMOOTH(uint16_t numReadings = 10) : _nxtReading(0), _numFilled(0), _total(0)
             {
                 if (numReadings > 100)
                 {
@@ -41,29 +58,198 @@ namespace EZ
                 memset(_rawReadings, 0, sizeof(_T) * _numReadings);
             }
 
-            ~SMOOTH() { delete _rawReadings; }
+            ~SMOOTH() { delete[] _rawReadings; }
 
             _T smooth(_T value)
             {
                 if (_numReadings <= 1)
                     return value;
-                _rawReadings[_nxtReading++] = value;
 
-                _T total = 0;
-                for (int r = 0; r < _nxtReading; r++)
-                    total += _rawReadings[r];
-                total /= _nxtReading > 0 ? _nxtReading : 1;
+                if (_numFilled < _numReadings)
+                    _numFilled++;
+                else
+                    _total -= _rawReadings[_nxtReading];
+
+                _rawReadings[_nxtReading] = value;
+                _total += value;
 
-                if (_nxtReading >= _numReadings)
+                if (++_nxtReading >= _numReadings)
                     _nxtReading = 0;
 
-                return total;
+                return (_T)(_total / _numFilled);
             }
 
         protected:
             uint16_t _nxtReading;
             uint16_t _numReadings;
+            uint16_t _numFilled;
+            ACCUMULATOR<_T> _total;
             _T* _rawReadings;
+
+        private:
+            SMOOTH(SMOOTH const& copy);            // Not Implemented
+            SMOOTH& operator=(SMOOTH const& copy); // Not Implemented
+        };
+
+        /*
+        ** AVERAGE - Moving average over a fixed window of _N samples, O(1) per sample and
+        ** no heap. For integer types, a power of two _N lets the divide become a shift.
+        */
+        template<class _T, uint16_t _N, class _S = ACCUMULATOR<_T>> class AVERAGE
+        {
+            static_assert(_N > 0, "AVERAGE window must not be empty");
+            // _N samples of the largest magnitude must fit _S, compared as magnitude <= max / _N
+            // so it can't overflow itself (64 bit integer samples never fit, use a double)
+            static_assert(!std::is_integral<_T>::value || !std::is_integral<_S>::value ||
+                              (std::is_signed<_T>::value ? (uint64_t)(std::numeric_limits<_T>::max)() <
+                                                               (uint64_t)(std::numeric_limits<_S>::max)() / _N
+                                                         : (uint64_t)(std::numeric_limits<_T>::max)() <=
+                                                               (uint64_t)(std::numeric_limits<_S>::max)() / _N),
+                          "AVERAGE window overflows its accumulator");
+
+        public:
+            AVERAGE() { reset(); }
+
+            void reset(void)
+            {
+                _next = _count = 0;
+                _total = 0;
+            }
+
+            _T smooth(_T value)
+            {
+                if (_count < _N)
+                    _count++;
+                else
+                    _total -= _window[_next];
+
+                _window[_next] = value;
+                _total += value;
+
+                if (++_next >= _N)
+                    _next = 0;
+
+                return this->value();
+            }
+
+            _T value(void) const { return _count ? (_T)(_total / (_S)_count) : 0; }
+
+        private:
+            _T _window[_N];
+            _S _total;
+            uint16_t _next;
+            uint16_t _count;
+        };
+
+        /*
+        ** EMA - Exponential moving average, alpha = 1 / 2^_SHIFT. Integer types keep the
+        ** average scaled by 2^_SHIFT so there's no loss of resolution, and no divide.
+        */
+        template<class _T, uint8_t _SHIFT = 3, class _S = ACCUMULATOR<_T>> class EMA
+        {
+        public:
+            EMA() : _state(0), _primed(false) {}
+
+            void reset(void) { _primed = false; }
+
+            _T smooth(_T value)
+            {
+                if (!_primed)
+                {
+                    _state = _scale(value, std::is_integral<_S>());
+                    _primed = true;
+                }
+                else
+                    _state = _update(value, std::is_integral<_S>());
+
+                return this->value();
+            }
+
+            _T value(void) const { return _unscale(std::is_integral<_S>()); }
+
+        private:
+            _S _state;
+            bool _primed;
+
+            _S _scale(_T value, std::true_type) const { return (_S)value << _SHIFT; }
+            _S _scale(_T value, std::false_type) const { return (_S)value; }
+            _S _update(_T value, std::true_type) const { return _state - (_state >> _SHIFT) + value; }
+            _S _update(_T value, std::false_type) const
+            {
+                return _state + ((_S)value - _state) / (_S)(1UL << _SHIFT);
+            }
+            _T _unscale(std::true_type) const { return (_T)((_state + ((_S)1 << (_SHIFT - 1))) >> _SHIFT); }
+            _T _unscale(std::false_type) const { return (_T)_state; }
+
+            static_assert(_SHIFT > 0 && _SHIFT < 16, "EMA shift must be 1..15");
+        };
+
+        /*
+        ** MEDIAN - Windowed median of the last _N (odd) samples. Samples are held in arrival
+        ** order and in a small sorted array, each new sample replaces the oldest with one
+        ** binary search and a short move, rejecting spikes that averaging would smear.
+        */
+        template<class _T, uint8_t _N = 5> class MEDIAN
+        {
+            static_assert(_N & 1, "MEDIAN window must be odd");
+
+        public:
+            MEDIAN() : _next(0), _count(0) {}
+
+            void reset(void) { _next = _count = 0; }
+
+            _T smooth(_T value)
+            {
+                uint8_t pos;
+
+                if (_count < _N)
+                {
+                    pos = _count++;
+                }
+                else
+                {
+                    // Remove the oldest sample from the sorted set
+                    pos = _find(_window[_next]);
+                    memmove(&_sorted[pos], &_sorted[pos + 1], (_N - 1 - pos) * sizeof(_T));
+                    pos = _N - 1;
+                }
+
+                // Insert the new one
+                uint8_t at = _find(value, pos);
+                memmove(&_sorted[at + 1], &_sorted[at], (pos - at) * sizeof(_T));
+                _sorted[at] = value;
+
+                _window[_next] = value;
+                if (++_next >= _N)
+                    _next = 0;
+
+                return this->value();
+            }
+
+            _T value(void) const { return _count ? _sorted[_count / 2] : 0; }
+
+        private:
+            _T _window[_N];
+            _T _sorted[_N];
+            uint8_t _next;
+            uint8_t _count;
+
+            // Lower bound of value in the first count sorted entries
+            uint8_t _find(_T value, uint8_t count = _N) const
+            {
+                uint8_t lo = 0, hi = count;
+
+                while (lo < hi)
+                {
+                    uint8_t mid = (lo + hi) >> 1;
+
+                    if (_sorted[mid] < value)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+                return lo;
+            }
         };
     } // namespace HAL
 } // namespace EZ
@@ -0,0 +1,171 @@
+/*
+** EZIoT - Pixel Command Queue
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_PIXEL_COMMANDS_H
+#define _EZ_PIXEL_COMMANDS_H
+#include "pixel_handler.h"
+#include <atomic>
+
+namespace EZ
+{
+    namespace PIXEL
+    {
+        /*
+        ** COMMANDS - Lock-free single producer, single consumer queue of handler changes
+        **
+        ** The control side (one task, e.g. the HTTP/UPnP loop) queues setMode(), setColor() ...
+        ** instead of calling the handler, the render side (one task, e.g. the NEO::SCHEDULER or
+        ** loop() before service()) calls apply() between frames. Neither ever blocks, a full queue
+        ** makes the control call return false.
+        **
+        ** Commands queued between hold() and release() are published together, so apply() sees
+        ** all of them or none and a frame never shows half a change.
+        */
+        class COMMANDS
+        {
+        public:
+            COMMANDS(uint16_t size = 32) : _queue(nullptr), _mask(0), _head(0), _tail(0), _pending(0), _held(0)
+            {
+                uint32_t n = 1;
+
+                // Power of 2, so the free running indices wrap cleanly
+                while (n < size && n < 0x8000)
+                    n <<= 1;
+
+                if ((_queue = (command_t*)malloc(n * sizeof(command_t))))
+                    _mask = n - 1;
+            }
+
+            ~COMMANDS()
+            {
+                if (_queue)
+                    free(_queue);
+            }
+
+            // Control side
+            //
+            bool setMode(HANDLER& h, uint8_t mode, uint8_t options = EZ_PIXEL_OPTION_NONE)
+            {
+                return _push(&h, MODE, mode, options, 0);
+            }
+            bool setColor(HANDLER& h, uint8_t n, COLOR c) { return _push(&h, COLOR_N, n, 0, c.u); }
+            bool setSpeed(HANDLER& h, uint16_t speed) { return _push(&h, SPEED, 0, 0, speed); }
+            bool setLevel(HANDLER& h, uint8_t level) { return _push(&h, LEVEL, level, 0, 0); }
+            bool setOptions(HANDLER& h, uint8_t options) { return _push(&h, OPTIONS, options, 0, 0); }
+            bool trigger(HANDLER& h) { return _push(&h, TRIGGER, 0, 0, 0); }
+
+            // Free slots, check before a held batch so it can't be left half queued
+            uint16_t room(void) { return _queue ? (_mask + 1) - (_pending - _head.load(std::memory_order_acquire)) : 0; }
+
+            void hold(void) { _held++; }
+            void release(void)
+            {
+                if (_held && !--_held)
+                    _tail.store(_pending, std::memory_order_release);
+            }
+
+            // Render side, returns the number of commands applied
+            //
+            uint16_t apply(void)
+            {
+                uint32_t head = _head.load(std::memory_order_relaxed);
+                uint32_t tail = _tail.load(std::memory_order_acquire);
+                uint16_t count = 0;
+
+                for (; head != tail; head++, count++)
+                {
+                    command_t& cmd = _queue[head & _mask];
+                    HANDLER* h = cmd.handler;
+
+                    switch (cmd.op)
+                    {
+                    case MODE:
+                        h->setMode(cmd.a, cmd.b);
+                        break;
+                    case COLOR_N:
+                        h->setColor(cmd.a, COLOR(cmd.value));
+                        break;
+                    case SPEED:
+                        h->setSpeed(cmd.value);
+                        break;
+                    case LEVEL:
+                        h->setLevel(cmd.a);
+                        break;
+                    case OPTIONS:
+                        h->setOptions(cmd.a);
+                        break;
+                    case TRIGGER:
+                        h->trigger();
+                        break;
+                    }
+                }
+
+                _head.store(head, std::memory_order_release);
+                return count;
+            }
+
+            bool empty(void) { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+
+        protected:
+            typedef enum : uint8_t
+            {
+                MODE = 0,
+                COLOR_N,
+                SPEED,
+                LEVEL,
+                OPTIONS,
+                TRIGGER
+            } op_t;
+
+            typedef struct
+            {
+                HANDLER* handler;
+                uint32_t value;
+                op_t op;
+                uint8_t a;
+                uint8_t b;
+            } command_t;
+
+            command_t* _queue;
+            uint32_t _mask;
+            std::atomic<uint32_t> _head; // Next to apply, written by the render side
+            std::atomic<uint32_t> _tail; // Next free, published by the control side
+            uint32_t _pending;           // Control side's tail, ahead of _tail while held
+            uint8_t _held;
+
+            bool _push(HANDLER* h, op_t op, uint8_t a, uint8_t b, uint32_t value)
+            {
+                if (!_queue || (_pending - _head.load(std::memory_order_acquire)) > _mask)
+                    return false;
+
+                command_t& cmd = _queue[_pending & _mask];
+
+                cmd.handler = h;
+                cmd.value = value;
+                cmd.op = op;
+                cmd.a = a;
+                cmd.b = b;
+                _pending++;
+
+                if (!_held)
+                    _tail.store(_pending, std::memory_order_release);
+                return true;
+            }
+
+        private:
+            COMMANDS(COMMANDS const& copy);            // Not Implemented
+            COMMANDS& operator=(COMMANDS const& copy); // Not Implemented
+        };
+    } // namespace PIXEL
+} // namespace EZ
+#endif // _EZ_PIXEL_COMMANDS_H
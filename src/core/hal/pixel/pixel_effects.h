@@ -19,25 +19,21 @@
 #define _EZ_PIXEL_EFFECTS_H
 #pragma once
 
+#include <type_traits>
+
 #define FSH(x) (__FlashStringHelper*)(x)
 
+// Bytes of per-handler state available to the running effect
+#define EZ_PIXEL_FX_STATE 16
+
 namespace EZ
 {
     namespace PIXEL
     {
-        // Custom FX class
+        // Forward reference
         //
         class HANDLER;
 
-        class EFFECT {
-            public:
-                EFFECT();
-                virtual uint16_t call(HANDLER& pixels) = 0;
-                const char *name(void) const { return _name; }
-            private:
-                const char *_name;
-        };
-
         // Built-in FX names 
         //
         const char fx_0[] PROGMEM = "Off";
@@ -104,19 +100,53 @@ namespace EZ
         const char fx_61[] PROGMEM = "Custom #2";
         const char fx_62[] PROGMEM = "Custom #3";
 
-        static const __FlashStringHelper* modeNames[] = {
-            FSH(fx_0),  FSH(fx_1),  FSH(fx_2),  FSH(fx_3),  FSH(fx_4),  FSH(fx_5),  FSH(fx_6),  FSH(fx_7),  FSH(fx_8),
-            FSH(fx_9),  FSH(fx_10), FSH(fx_11), FSH(fx_12), FSH(fx_13), FSH(fx_14), FSH(fx_15), FSH(fx_16), FSH(fx_17),
-            FSH(fx_18), FSH(fx_19), FSH(fx_20), FSH(fx_21), FSH(fx_22), FSH(fx_23), FSH(fx_24), FSH(fx_25), FSH(fx_26),
-            FSH(fx_27), FSH(fx_28), FSH(fx_29), FSH(fx_30), FSH(fx_31), FSH(fx_32), FSH(fx_33), FSH(fx_34), FSH(fx_35),
-            FSH(fx_36), FSH(fx_37), FSH(fx_38), FSH(fx_39), FSH(fx_40), FSH(fx_41), FSH(fx_42), FSH(fx_43), FSH(fx_44),
-            FSH(fx_45), FSH(fx_46), FSH(fx_47), FSH(fx_48), FSH(fx_49), FSH(fx_50), FSH(fx_51), FSH(fx_52), FSH(fx_53),
-            FSH(fx_54), FSH(fx_55), FSH(fx_56), FSH(fx_57), FSH(fx_58), FSH(fx_59), FSH(fx_60), FSH(fx_61), FSH(fx_62)};
+        // Mode numbers, the built-ins (fx_0..) are the EFFECT table in HANDLER::_effect(), which
+        // fails to compile unless it holds exactly CUSTOM_FX1 entries, the CUSTOM_FX slots follow.
+        //
+        static const uint8_t CUSTOM_FX1 = 60;
+        static const uint8_t CUSTOM_FX2 = (CUSTOM_FX1 + 1);
+        static const uint8_t CUSTOM_FX3 = (CUSTOM_FX2 + 1);
+        static const uint8_t MODE_COUNT = (CUSTOM_FX3 + 1);
+
+        /*
+        ** EFFECT - Effect registry entry
+        **
+        ** An effect is a plain frame function, called once per frame with the handler and its own
+        ** state block (stateSize bytes held by the handler, zeroed whenever the mode changes), it
+        ** returns the delay in ms until its next frame. The built-ins (0..CUSTOM_FX1-1) are a single
+        ** constexpr table in flash shared by every handler, the CUSTOM_FX slots are a small RAM table
+        ** filled by HANDLER::registerEffect().
+        */
+        typedef uint16_t (*effect_frame_t)(HANDLER& pixels, void* state);
+
+        typedef struct EFFECT
+        {
+            const char* name; // PROGMEM
+            effect_frame_t frame;
+            uint8_t stateSize;
+        } effect_t;
 
-        static const uint8_t MODE_COUNT = (sizeof(modeNames) / sizeof(modeNames[0]));
-        static const uint8_t CUSTOM_FX3 = (MODE_COUNT - 1);
-        static const uint8_t CUSTOM_FX2 = (CUSTOM_FX3 - 1);
-        static const uint8_t CUSTOM_FX1 = (CUSTOM_FX2 - 1);
+        template<class _STATE, uint16_t (*_FRAME)(HANDLER&, _STATE&)> uint16_t __fxFrame(HANDLER& pixels, void* state)
+        {
+            return _FRAME(pixels, *(_STATE*)state);
+        }
+
+        // Build an entry for a frame function taking its own state type, e.g.
+        //
+        // struct SPARK { uint16_t pos; uint8_t hue; };
+        // uint16_t spark(HANDLER& pixels, SPARK& state) { ... }
+        //
+        // HANDLER::registerEffect(CUSTOM_FX1, effect<SPARK, spark>(F("Spark")));
+        //
+        // The cast back to _STATE is compiled into the entry, so a custom effect costs one
+        // indirect call per frame, the same as a built-in.
+        //
+        template<class _STATE, uint16_t (*_FRAME)(HANDLER&, _STATE&)> EFFECT effect(const __FlashStringHelper* name)
+        {
+            static_assert(sizeof(_STATE) <= EZ_PIXEL_FX_STATE, "Effect state exceeds EZ_PIXEL_FX_STATE");
+            static_assert(std::is_trivial<_STATE>::value, "Effect state must be trivial (it is zero filled)");
+            return {(const char*)name, &__fxFrame<_STATE, _FRAME>, sizeof(_STATE)};
+        }
 
     } // namespace PIXEL
 } // namespace EZ
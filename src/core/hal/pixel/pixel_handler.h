@@ -22,6 +22,7 @@
 #include "core/tool/ez_sine.h"
 #include "pixel_sequence.h"
 #include "pixel_effects.h"
+#include "pixel_kernels.h"
 
 #define EZ_PIXEL_SPEED_MIN (uint16_t)2
 #define EZ_PIXEL_SPEED_MAX (uint16_t)65535
@@ -120,12 +121,16 @@ namespace EZ
         {
         public:
             friend class SEGMENT;
+            friend class VIEW;
+            friend class LAYER;
+            friend class COMPOSITOR;
 
             HANDLER(pixel_order_t order, uint16_t count)
                 : _grey(COLOR::GREY_MODE::LUMINANCE), _mode(EZ_PIXEL_DEFAULT_MODE), _state(EZ_PIXEL_STATE_OFF),
                   _level(EZ_PIXEL_DEFAULT_LEVEL), _speed(EZ_PIXEL_DEFAULT_SPEED), _rOffset(0), _gOffset(0), _bOffset(0),
-                  _wOffset(0), _pixelLevel(0), _pixelData(nullptr), _pixelOrder(order), _pixelCount(0), _pixelBits(0),
-                  _pixelSize(0), _isDirty(false), _triggered(false)
+                  _wOffset(0), _pixelLevel(0), _pixelData(nullptr), _wireData(nullptr), _pixelOrder(order), _pixelCount(0),
+                  _pixelBits(0), _pixelSize(0), _isDirty(false), _triggered(false), _gamma(false), _ownerData(nullptr),
+                  _ownerId(0), _headSegment(nullptr), _nextSegment(nullptr), _options(EZ_PIXEL_OPTION_NONE)
             {
                 if (count)
                 {
@@ -139,67 +144,6 @@ namespace EZ
                 _colors[2] = EZ_COLOR_BLUE;
                 _colors[3] = EZ_COLOR_RED;
 
-                _modeMethods[0] = &HANDLER::_modeDummy;
-                _modeMethods[1] = &HANDLER::_modeStatic;
-                _modeMethods[2] = &HANDLER::_modeBreathing;
-                _modeMethods[3] = &HANDLER::_modeBlink;
-                _modeMethods[4] = &HANDLER::_modeBlinkDuo;
-                _modeMethods[5] = &HANDLER::_modeBlinkRainbow;
-                _modeMethods[6] = &HANDLER::_modeStrobe;
-                _modeMethods[7] = &HANDLER::_modeStrobeDuo;
-                _modeMethods[8] = &HANDLER::_modeStrobeRainbow;
-                _modeMethods[9] = &HANDLER::_modeMultiStrobe;
-                _modeMethods[10] = &HANDLER::_modeColorWipe;
-                _modeMethods[11] = &HANDLER::_modeColorWipeInv;
-                _modeMethods[12] = &HANDLER::_modeColorWipeRev;
-                _modeMethods[13] = &HANDLER::_modeColorWipeInvRev;
-                _modeMethods[14] = &HANDLER::_modeColorWipeRandom;
-                _modeMethods[15] = &HANDLER::_modeColorSweepRandom;
-                _modeMethods[16] = &HANDLER::_modeRandomColor;
-                _modeMethods[17] = &HANDLER::_modeSingleDynamic;
-                _modeMethods[18] = &HANDLER::_modeMultiDynamic;
-                _modeMethods[19] = &HANDLER::_modeRainbow;
-                _modeMethods[20] = &HANDLER::_modeRainbowCycle;
-                _modeMethods[21] = &HANDLER::_modeFader;
-                _modeMethods[22] = &HANDLER::_modeTheaterChase;
-                _modeMethods[23] = &HANDLER::_modeTheaterChaseRainbow;
-                _modeMethods[24] = &HANDLER::_modeTwinkle;
-                _modeMethods[25] = &HANDLER::_modeTwinkleRandom;
-                _modeMethods[26] = &HANDLER::_modeTwinkleFade;
-                _modeMethods[27] = &HANDLER::_modeTwinkleFadeRandom;
-                _modeMethods[28] = &HANDLER::_modeSparkle;
-                _modeMethods[29] = &HANDLER::_modeFlashSparkle;
-                _modeMethods[30] = &HANDLER::_modeHyperSparkle;
-                _modeMethods[31] = &HANDLER::_modeRunningLights;
-                _modeMethods[32] = &HANDLER::_modeRunningRandom;
-                _modeMethods[33] = &HANDLER::_modeRunningColor;
-                _modeMethods[34] = &HANDLER::_modeRunningEmergency;
-                _modeMethods[35] = &HANDLER::_modeRunningHalloween;
-                _modeMethods[36] = &HANDLER::_modeRunningChristmas;
-                _modeMethods[37] = &HANDLER::_modeScan;
-                _modeMethods[38] = &HANDLER::_modeDualScan;
-                _modeMethods[39] = &HANDLER::_modeLarsonScanner;
-                _modeMethods[40] = &HANDLER::_modeLarsonRainbow;
-                _modeMethods[41] = &HANDLER::_modeICU;
-                _modeMethods[42] = &HANDLER::_modeChaseWhite;
-                _modeMethods[43] = &HANDLER::_modeChaseColor;
-                _modeMethods[44] = &HANDLER::_modeChaseRandom;
-                _modeMethods[45] = &HANDLER::_modeChaseRainbowWhite;
-                _modeMethods[46] = &HANDLER::_modeChaseWhiteRainbow;
-                _modeMethods[47] = &HANDLER::_modeChaseBlack;
-                _modeMethods[48] = &HANDLER::_modeChaseRainbowBlack;
-                _modeMethods[49] = &HANDLER::_modeChaseFlash;
-                _modeMethods[50] = &HANDLER::_modeChaseFlashRandom;
-                _modeMethods[51] = &HANDLER::_modeBiColorChase;
-                _modeMethods[52] = &HANDLER::_modeTriColorChase;
-                _modeMethods[53] = &HANDLER::_modeCircusCombustus;
-                _modeMethods[54] = &HANDLER::_modeComet;
-                _modeMethods[55] = &HANDLER::_modeFireworks;
-                _modeMethods[56] = &HANDLER::_modeFireworksRandom;
-                _modeMethods[57] = &HANDLER::_modeFireFlicker;
-                _modeMethods[58] = &HANDLER::_modeFireFlickerSoft;
-                _modeMethods[59] = &HANDLER::_modeFireFlickerIntense;
-
                 _reset();
             }
 
@@ -207,8 +151,14 @@ namespace EZ
             {
                 if (_pixelData)
                 {
-                    _pixelData = _memFree(_pixelData);
+                    _pixelData = (COLOR*)_memFree((uint8_t*)_pixelData);
                 }
+
+                if (_wireData)
+                    free(_wireData);
+
+                if (_ownerData)
+                    free(_ownerData); // Only the root's, segments drop their view of it first
             }
 
             bool service(void)
@@ -217,11 +167,11 @@ namespace EZ
 
                 if (_state != EZ_PIXEL_STATE_OFF || _triggered)
                 {
-                    // Be aware, millis() rolls over every 49 days
-                    unsigned long now = millis();
+                    // Signed difference, so the deadline survives millis() rolling over (49 days)
+                    uint32_t now = millis();
                     uint16_t delay = 0;
 
-                    if (now > _next_time || _triggered)
+                    if ((int32_t)(now - _next_time) >= 0 || _triggered)
                     {
                         _isFrame = true;
                         _isCycle = false;
@@ -258,8 +208,7 @@ namespace EZ
                         }
                         else
                         {
-                            delay = (this->*_modeMethods[_mode])();
-                            _counter_mode_call++;
+                            delay = _frame();
                         }
 
                         _next_time = now + max(delay, EZ_PIXEL_SPEED_MIN);
@@ -273,6 +222,16 @@ namespace EZ
             bool isCycle(void) { return _isCycle; }
             void trigger(void) { _triggered = true; }
 
+            // For effects: flag the end of a cycle, and the frames since the mode was set
+            //
+            void setCycle(void) { _isCycle = true; }
+            uint32_t frames(void) { return _counter_mode_call; }
+
+            // For schedulers: whether service() has anything to do, and the millis() it next will
+            //
+            bool running(void) { return _state != EZ_PIXEL_STATE_OFF || _triggered; }
+            uint32_t due(void) { return _triggered ? millis() : _next_time; }
+
             // Set mode
             //
             // mode = 0 : off
@@ -314,7 +273,7 @@ namespace EZ
             {
                 if (m < MODE_COUNT)
                 {
-                    return modeNames[m];
+                    return FSH(_effect(m).name);
                 }
                 else
                 {
@@ -322,6 +281,24 @@ namespace EZ
                 }
             }
 
+            // Effect registry, shared by every handler. Fill a CUSTOM_FX1..3 slot with an effect built
+            // by effect<>(), the name is optional. Not to be called while handlers are running the
+            // slot being replaced.
+            //
+            static bool registerEffect(uint8_t mode, const EFFECT& fx)
+            {
+                if (mode < CUSTOM_FX1 || mode >= MODE_COUNT || !fx.frame || fx.stateSize > EZ_PIXEL_FX_STATE)
+                    return false;
+
+                EFFECT* slot = &_custom()[mode - CUSTOM_FX1];
+
+                slot->frame = fx.frame;
+                slot->stateSize = fx.stateSize;
+                if (fx.name)
+                    slot->name = fx.name;
+                return true;
+            }
+
             // Grey mode
             //
             COLOR::GREY_MODE getGreyMode(void) { return _grey; }
@@ -384,12 +361,14 @@ namespace EZ
             // Fill with single color
             //
             void fill(uint8_t m) { fill(m, m, m, m); }
-            void fill(COLOR c) { fill(c.r, c.g, c.b, c.w); }
-            void fill(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0)
+            void fill(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) { fill(COLOR(r, g, b, w)); }
+            void fill(COLOR c)
             {
-                for (int n = 0; n < _pixelCount; n++)
+                if (_pixelData)
                 {
-                    setPixel(n, r, g, b, w);
+                    PIXEL::fill(_pixelData, _pixelCount, c);
+                    _setOwner(0, _pixelCount);
+                    _setDirty();
                 }
             }
 
@@ -401,78 +380,21 @@ namespace EZ
             {
                 if ((_pixelData) && n < _pixelCount)
                 {
-                    uint8_t* p;
-
-                    if (_pixelLevel)
-                    {
-                        r = (r * _pixelLevel) >> 8;
-                        g = (g * _pixelLevel) >> 8;
-                        b = (b * _pixelLevel) >> 8;
-                        w = (w * _pixelLevel) >> 8;
-                    }
-
-                    if (_pixelOrder != ORDER::MONO)
-                    {
-                        if (_wOffset == _rOffset)
-                        {                           // RGB-type strip
-                            p = &_pixelData[n * 3]; // 3 bytes per pixel
-                        }
-                        else
-                        {                           // RGBW-type strip
-                            p = &_pixelData[n * 4]; // 4 bytes per pixel
-                            p[_wOffset] = w;        // Store W
-                        }
-
-                        p[_rOffset] = r; // R,G,B always stored
-                        p[_gOffset] = g;
-                        p[_bOffset] = b;
-                    }
-                    else
-                    {
-                        COLOR mono(r, g, b, w);
-                        _pixelData[n] = mono.getGrey(_grey);
-                    }
-
+                    _pixelData[n].set(r, g, b, w);
+                    if (_ownerData)
+                        _ownerData[n] = _ownerId;
                     _setDirty();
                 }
             }
 
-            // Get a single pixel
+            // Get a single pixel, exactly as it was set (level and gamma are only applied on output)
             //
             COLOR getPixel(uint16_t n)
             {
-                COLOR c(0);
-
                 if ((_pixelData) && n < _pixelCount)
-                {
-                    if (_pixelOrder != ORDER::MONO)
-                    {
-                        uint8_t* p = &_pixelData[n * ((_wOffset == _rOffset) ? 3 : 4)];
-
-                        if (_pixelLevel)
-                        {
-                            c.r = (p[_rOffset] << 8) / _pixelLevel;
-                            c.g = (p[_gOffset] << 8) / _pixelLevel;
-                            c.b = (p[_bOffset] << 8) / _pixelLevel;
-                            if (_wOffset != _rOffset)
-                                c.w = (p[_wOffset] << 8) / _pixelLevel;
-                        }
-                        else
-                        {
-                            c.r = p[_rOffset];
-                            c.g = p[_gOffset];
-                            c.b = p[_bOffset];
-                            if (_wOffset != _rOffset)
-                                c.w = p[_wOffset];
-                        }
-                    }
-                    else
-                    {
-                        c.r = c.g = c.b = c.w = (_pixelLevel ? (_pixelData[n] << 8) / _pixelLevel : _pixelData[n]);
-                    }
-                }
+                    return _pixelData[n];
 
-                return c;
+                return COLOR(0);
             }
 
             // Change Pixel Levels
@@ -488,27 +410,12 @@ namespace EZ
                 // 1 = min brightness level (off)
                 // 255 = just below max brightness level.
                 //
+                // The pixel data is left untouched, the new level is applied by output()
+                //
                 uint8_t newLevel = level + 1;
 
-                if ((_pixelData) && newLevel != _pixelLevel)
+                if (newLevel != _pixelLevel)
                 {
-                    // Level has changed -- re-scale existing data in RAM
-                    uint8_t c, *ptr = (uint8_t*)_pixelData, oldLevel = _pixelLevel - 1;
-                    uint16_t scale;
-
-                    if (oldLevel == 0)
-                        scale = 0; // Avoid /0
-                    else if (level == 255)
-                        scale = 65535 / oldLevel;
-                    else
-                        scale = (((uint16_t)newLevel << 8) - 1) / oldLevel;
-
-                    for (uint16_t i = 0; i < _pixelBytes; i++)
-                    {
-                        c = *ptr;
-                        *ptr++ = (c * scale) >> 8;
-                    }
-
                     _pixelLevel = newLevel;
                     _setDirty();
                 }
@@ -516,12 +423,43 @@ namespace EZ
 
             uint8_t getPixelLevel(void) { return _pixelLevel - 1; }
 
+            // Gamma correction on output, off unless asked for
+            //
+            void setGamma(bool gamma)
+            {
+                _gamma = gamma;
+                _setDirty();
+            }
+
+            bool getGamma(void) { return _gamma; }
+
+            // Output stage, produces the wire buffer (_pixelBytes long) from the pixel data by
+            // applying level, gamma, color order and RGBW/mono packing in a single pass. A pixel
+            // is output at the level (and gamma) of the handler or segment that last wrote it.
+            // Returns nullptr if the wire buffer can't be allocated.
+            //
+            uint8_t* output(void)
+            {
+                if (!_pixelData)
+                    return nullptr;
+
+                if (!_wireData && !(_wireData = (uint8_t*)malloc(_pixelBytes)))
+                    return nullptr;
+
+                _outputRange(0, _pixelCount, _pixelLevel, _gamma, _ownerId);
+                _outputSegments(this);
+                return _wireData;
+            }
+
             // Blackout!
             //
             void clear(void)
             {
                 if (_pixelData)
-                    memset(_pixelData, 0, _pixelBytes);
+                {
+                    PIXEL::fill(_pixelData, _pixelCount, EZ_COLOR_BLACK);
+                    _setOwner(0, _pixelCount);
+                }
                 _setDirty();
             }
 
@@ -538,7 +476,8 @@ namespace EZ
             uint8_t _bOffset;
             uint8_t _wOffset;
             uint8_t _pixelLevel;
-            uint8_t* _pixelData;
+            COLOR* _pixelData; // Logical pixels, full precision
+            uint8_t* _wireData; // Output pixels, _pixelBytes in strand order
             pixel_order_t _pixelOrder;
             uint16_t _pixelCount;
             size_t _pixelBytes;
@@ -547,17 +486,29 @@ namespace EZ
             bool _isDirty;
             bool _isCycle;
             bool _triggered;
+            bool _gamma;
+
+            uint8_t* _ownerData; // Per pixel, the _ownerId that last wrote it (once there are segments)
+            uint8_t _ownerId;    // 0 for a handler, segments are numbered from 1
+            HANDLER* _headSegment; // Segments viewing this handler's pixels
+            HANDLER* _nextSegment;
 
             COLOR _colors[MAX_SFX_COLORS];
 
             uint8_t _options;
-            unsigned long _next_time;
-            uint32_t _counter_mode_step;
+            uint32_t _next_time;
             uint32_t _counter_mode_call;
-            uint8_t _aux_param1;  // auxilary param (usually stores a color_wheel index)
-            uint16_t _aux_param2; // auxilary param (usually stores a segment index)
 
-            mode_method_t _modeMethods[MODE_COUNT];
+            // State of the running effect, a built-in's is _fx
+            union {
+                struct
+                {
+                    uint32_t step;
+                    uint16_t aux2; // usually a segment index
+                    uint8_t aux1;  // usually a color_wheel index
+                } _fx;
+                alignas(8) uint8_t _fxState[EZ_PIXEL_FX_STATE];
+            };
 
             inline virtual void _setDirty(void) { _isDirty = true; }
 
@@ -568,15 +519,202 @@ namespace EZ
                 return nullptr;
             }
 
+            virtual HANDLER* _rootHandler(void) { return this; }
+
+            void _setOwner(uint16_t first, uint16_t count)
+            {
+                if (_ownerData)
+                    memset(&_ownerData[first], _ownerId, count);
+            }
+
+            // Outputs the pixels in range written by owner
+            //
+            void _outputRange(uint16_t first, uint16_t count, uint8_t level, bool gamma, uint8_t owner)
+            {
+                COLOR* src = &_pixelData[first];
+                uint8_t* dst = &_wireData[first * _pixelSize];
+                uint8_t* tag = _ownerData ? &_ownerData[first] : nullptr;
+
+                for (uint16_t n = 0; n < count; n++)
+                {
+                    if (tag && tag[n] != owner)
+                        continue;
+
+                    COLOR c = src[n];
+                    uint8_t* p = &dst[n * _pixelSize];
+
+                    if (level)
+                    {
+                        c.r = (c.r * level) >> 8;
+                        c.g = (c.g * level) >> 8;
+                        c.b = (c.b * level) >> 8;
+                        c.w = (c.w * level) >> 8;
+                    }
+
+                    if (gamma)
+                    {
+                        c.r = gamma8(c.r);
+                        c.g = gamma8(c.g);
+                        c.b = gamma8(c.b);
+                        c.w = gamma8(c.w);
+                    }
+
+                    if (_pixelOrder == ORDER::MONO)
+                    {
+                        *p = c.getGrey(_grey);
+                        continue;
+                    }
+
+                    if (_wOffset != _rOffset)
+                        p[_wOffset] = c.w;
+
+                    p[_rOffset] = c.r;
+                    p[_gOffset] = c.g;
+                    p[_bOffset] = c.b;
+                }
+            }
+
+            void _outputSegments(HANDLER* parent)
+            {
+                for (HANDLER* seg = parent->_headSegment; seg; seg = seg->_nextSegment)
+                {
+                    if (seg->_pixelData && seg->_ownerId)
+                        _outputRange(seg->_pixelData - _pixelData, seg->_pixelCount, seg->_pixelLevel, seg->_gamma,
+                                     seg->_ownerId);
+                    _outputSegments(seg);
+                }
+            }
+
+            // Segment numbering, the lowest number not in use below this handler
+            //
+            static void _ownerUsed(HANDLER* parent, uint32_t* used)
+            {
+                for (HANDLER* seg = parent->_headSegment; seg; seg = seg->_nextSegment)
+                {
+                    used[seg->_ownerId >> 5] |= 1UL << (seg->_ownerId & 31);
+                    _ownerUsed(seg, used);
+                }
+            }
+
+            uint8_t _ownerNext(void)
+            {
+                uint32_t used[256 / 32] = {1}; // 0 is ours
+
+                if (!_ownerData && _pixelCount && !(_ownerData = (uint8_t*)calloc(_pixelCount, 1)))
+                    return 0;
+
+                _ownerUsed(this, used);
+
+                for (uint16_t id = 1; id < 256; id++)
+                {
+                    if (!(used[id >> 5] & (1UL << (id & 31))))
+                        return id;
+                }
+
+                return 0;
+            }
+
             void _reset()
             {
                 _isCycle = false;
-                _next_time = 0;
-                _aux_param1 = 0;
-                _aux_param2 = 0;
-                _counter_mode_call = _counter_mode_step = 0;
+                _next_time = millis();
+                _counter_mode_call = 0;
+                memset(_fxState, 0, sizeof(_fxState));
             }
 
+            // The registry. Built-ins are constexpr so the table lives in flash, one copy for every
+            // handler, only the custom slots take RAM.
+            //
+            static const EFFECT& _effect(uint8_t mode)
+            {
+                static constexpr EFFECT builtins[] = {
+                    {fx_0, &_builtin<&HANDLER::_modeDummy>, sizeof(_fx)},
+                    {fx_1, &_builtin<&HANDLER::_modeStatic>, sizeof(_fx)},
+                    {fx_2, &_builtin<&HANDLER::_modeBreathing>, sizeof(_fx)},
+                    {fx_3, &_builtin<&HANDLER::_modeBlink>, sizeof(_fx)},
+                    {fx_4, &_builtin<&HANDLER::_modeBlinkDuo>, sizeof(_fx)},
+                    {fx_5, &_builtin<&HANDLER::_modeBlinkRainbow>, sizeof(_fx)},
+                    {fx_6, &_builtin<&HANDLER::_modeStrobe>, sizeof(_fx)},
+                    {fx_7, &_builtin<&HANDLER::_modeStrobeDuo>, sizeof(_fx)},
+                    {fx_8, &_builtin<&HANDLER::_modeStrobeRainbow>, sizeof(_fx)},
+                    {fx_9, &_builtin<&HANDLER::_modeMultiStrobe>, sizeof(_fx)},
+                    {fx_10, &_builtin<&HANDLER::_modeColorWipe>, sizeof(_fx)},
+                    {fx_11, &_builtin<&HANDLER::_modeColorWipeInv>, sizeof(_fx)},
+                    {fx_12, &_builtin<&HANDLER::_modeColorWipeRev>, sizeof(_fx)},
+                    {fx_13, &_builtin<&HANDLER::_modeColorWipeInvRev>, sizeof(_fx)},
+                    {fx_14, &_builtin<&HANDLER::_modeColorWipeRandom>, sizeof(_fx)},
+                    {fx_15, &_builtin<&HANDLER::_modeColorSweepRandom>, sizeof(_fx)},
+                    {fx_16, &_builtin<&HANDLER::_modeRandomColor>, sizeof(_fx)},
+                    {fx_17, &_builtin<&HANDLER::_modeSingleDynamic>, sizeof(_fx)},
+                    {fx_18, &_builtin<&HANDLER::_modeMultiDynamic>, sizeof(_fx)},
+                    {fx_19, &_builtin<&HANDLER::_modeRainbow>, sizeof(_fx)},
+                    {fx_20, &_builtin<&HANDLER::_modeRainbowCycle>, sizeof(_fx)},
+                    {fx_21, &_builtin<&HANDLER::_modeFader>, sizeof(_fx)},
+                    {fx_22, &_builtin<&HANDLER::_modeTheaterChase>, sizeof(_fx)},
+                    {fx_23, &_builtin<&HANDLER::_modeTheaterChaseRainbow>, sizeof(_fx)},
+                    {fx_24, &_builtin<&HANDLER::_modeTwinkle>, sizeof(_fx)},
+                    {fx_25, &_builtin<&HANDLER::_modeTwinkleRandom>, sizeof(_fx)},
+                    {fx_26, &_builtin<&HANDLER::_modeTwinkleFade>, sizeof(_fx)},
+                    {fx_27, &_builtin<&HANDLER::_modeTwinkleFadeRandom>, sizeof(_fx)},
+                    {fx_28, &_builtin<&HANDLER::_modeSparkle>, sizeof(_fx)},
+                    {fx_29, &_builtin<&HANDLER::_modeFlashSparkle>, sizeof(_fx)},
+                    {fx_30, &_builtin<&HANDLER::_modeHyperSparkle>, sizeof(_fx)},
+                    {fx_31, &_builtin<&HANDLER::_modeRunningLights>, sizeof(_fx)},
+                    {fx_32, &_builtin<&HANDLER::_modeRunningRandom>, sizeof(_fx)},
+                    {fx_33, &_builtin<&HANDLER::_modeRunningColor>, sizeof(_fx)},
+                    {fx_34, &_builtin<&HANDLER::_modeRunningEmergency>, sizeof(_fx)},
+                    {fx_35, &_builtin<&HANDLER::_modeRunningHalloween>, sizeof(_fx)},
+                    {fx_36, &_builtin<&HANDLER::_modeRunningChristmas>, sizeof(_fx)},
+                    {fx_37, &_builtin<&HANDLER::_modeScan>, sizeof(_fx)},
+                    {fx_38, &_builtin<&HANDLER::_modeDualScan>, sizeof(_fx)},
+                    {fx_39, &_builtin<&HANDLER::_modeLarsonScanner>, sizeof(_fx)},
+                    {fx_40, &_builtin<&HANDLER::_modeLarsonRainbow>, sizeof(_fx)},
+                    {fx_41, &_builtin<&HANDLER::_modeICU>, sizeof(_fx)},
+                    {fx_42, &_builtin<&HANDLER::_modeChaseWhite>, sizeof(_fx)},
+                    {fx_43, &_builtin<&HANDLER::_modeChaseColor>, sizeof(_fx)},
+                    {fx_44, &_builtin<&HANDLER::_modeChaseRandom>, sizeof(_fx)},
+                    {fx_45, &_builtin<&HANDLER::_modeChaseRainbowWhite>, sizeof(_fx)},
+                    {fx_46, &_builtin<&HANDLER::_modeChaseWhiteRainbow>, sizeof(_fx)},
+                    {fx_47, &_builtin<&HANDLER::_modeChaseBlack>, sizeof(_fx)},
+                    {fx_48, &_builtin<&HANDLER::_modeChaseRainbowBlack>, sizeof(_fx)},
+                    {fx_49, &_builtin<&HANDLER::_modeChaseFlash>, sizeof(_fx)},
+                    {fx_50, &_builtin<&HANDLER::_modeChaseFlashRandom>, sizeof(_fx)},
+                    {fx_51, &_builtin<&HANDLER::_modeBiColorChase>, sizeof(_fx)},
+                    {fx_52, &_builtin<&HANDLER::_modeTriColorChase>, sizeof(_fx)},
+                    {fx_53, &_builtin<&HANDLER::_modeCircusCombustus>, sizeof(_fx)},
+                    {fx_54, &_builtin<&HANDLER::_modeComet>, sizeof(_fx)},
+                    {fx_55, &_builtin<&HANDLER::_modeFireworks>, sizeof(_fx)},
+                    {fx_56, &_builtin<&HANDLER::_modeFireworksRandom>, sizeof(_fx)},
+                    {fx_57, &_builtin<&HANDLER::_modeFireFlicker>, sizeof(_fx)},
+                    {fx_58, &_builtin<&HANDLER::_modeFireFlickerSoft>, sizeof(_fx)},
+                    {fx_59, &_builtin<&HANDLER::_modeFireFlickerIntense>, sizeof(_fx)},};
+
+                static_assert(sizeof(builtins) / sizeof(builtins[0]) == CUSTOM_FX1, "Built-in effects must end at CUSTOM_FX1");
+
+                return mode < CUSTOM_FX1 ? builtins[mode] : _custom()[mode - CUSTOM_FX1];
+            }
+
+            static EFFECT* _custom(void)
+            {
+                static EFFECT custom[MODE_COUNT - CUSTOM_FX1] = {
+                    {fx_60, nullptr, 0}, {fx_61, nullptr, 0}, {fx_62, nullptr, 0}};
+
+                return custom;
+            }
+
+            // Run a frame of the current mode
+            //
+            uint16_t _frame(void)
+            {
+                const EFFECT& fx = _effect(_mode);
+                uint16_t delay = fx.frame ? fx.frame(*this, _fxState) : _modeDummy();
+
+                _counter_mode_call++;
+                return delay;
+            }
+
+            template<mode_method_t _M> static uint16_t _builtin(HANDLER& pixels, void*) { return (pixels.*_M)(); }
+
             /**************
             ** Mode FX's **
             **************/
@@ -596,7 +734,7 @@ namespace EZ
             //
             uint16_t _modeBreathing(void)
             {
-                int lum = _counter_mode_step;
+                int lum = _fx.step;
 
                 if (lum > 255)
                     lum = 511 - lum; // lum = 15 -> 255 -> 15
@@ -632,10 +770,10 @@ namespace EZ
 
                 fill(color);
 
-                _counter_mode_step += 2;
+                _fx.step += 2;
 
-                if (_counter_mode_step > (512 - 15))
-                    _counter_mode_step = 15;
+                if (_fx.step > (512 - 15))
+                    _fx.step = 15;
 
                 return delay;
             }
@@ -650,22 +788,16 @@ namespace EZ
             uint16_t _modeStrobeRainbow(void) { return _helpBlink(_colorWheel(_counter_mode_call & 0xFF), 0, true); }
             uint16_t _modeMultiStrobe(void)
             {
-                for (uint16_t i = 0; i < _pixelCount; i++)
-                {
-                    setPixel(i, EZ_COLOR_BLACK);
-                }
+                clear();
 
                 uint16_t delay = 200 + ((9 - (_speed % 10)) * 100);
                 uint16_t count = 2 * ((_speed / 100) + 1);
 
-                if (_counter_mode_step < count)
+                if (_fx.step < count)
                 {
-                    if ((_counter_mode_step & 1) == 0)
+                    if ((_fx.step & 1) == 0)
                     {
-                        for (uint16_t i = 0; i < _pixelCount; i++)
-                        {
-                            setPixel(i, _colors[1]);
-                        }
+                        fill(_colors[1]);
                         delay = 20;
                     }
                     else
@@ -674,7 +806,7 @@ namespace EZ
                     }
                 }
 
-                _counter_mode_step = (_counter_mode_step + 1) % (count + 1);
+                _fx.step = (_fx.step + 1) % (count + 1);
                 return delay;
             }
 
@@ -686,12 +818,12 @@ namespace EZ
             uint16_t _modeColorWipeInvRev(void) { return _helpColorWipe(_colors[2], _colors[1], true); }
             uint16_t _modeColorWipeRandom(void)
             {
-                if (_counter_mode_step % _pixelCount == 0)
+                if (_fx.step % _pixelCount == 0)
                 {
-                    _aux_param1 = _randomWheelIndex(_aux_param1);
+                    _fx.aux1 = _randomWheelIndex(_fx.aux1);
                 }
 
-                COLOR color = _colorWheel(_aux_param1);
+                COLOR color = _colorWheel(_fx.aux1);
                 return _helpColorWipe(color, color, false) * 2;
             }
 
@@ -699,12 +831,12 @@ namespace EZ
             //
             uint16_t _modeColorSweepRandom(void)
             {
-                if (_counter_mode_step % _pixelCount == 0)
+                if (_fx.step % _pixelCount == 0)
                 {
-                    _aux_param1 = _randomWheelIndex(_aux_param1);
+                    _fx.aux1 = _randomWheelIndex(_fx.aux1);
                 }
 
-                COLOR color = _colorWheel(_aux_param1);
+                COLOR color = _colorWheel(_fx.aux1);
                 return _helpColorWipe(color, color, true) * 2;
             }
 
@@ -713,8 +845,8 @@ namespace EZ
             //
             uint16_t _modeRandomColor(void)
             {
-                _aux_param1 = _randomWheelIndex(_aux_param1);
-                COLOR color = _colorWheel(_aux_param1);
+                _fx.aux1 = _randomWheelIndex(_fx.aux1);
+                COLOR color = _colorWheel(_fx.aux1);
                 fill(color);
                 _isCycle = true;
                 return _speed;
@@ -755,9 +887,9 @@ namespace EZ
             //
             uint16_t _modeRainbow(void)
             {
-                COLOR color = _colorWheel(_counter_mode_step);
+                COLOR color = _colorWheel(_fx.step);
                 fill(color);
-                if ((_counter_mode_step = (_counter_mode_step + 1) & 0xFF) == 0xFF)
+                if ((_fx.step = (_fx.step + 1) & 0xFF) == 0xFF)
                     _isCycle = true;
                 return (_speed / 256);
             }
@@ -768,11 +900,11 @@ namespace EZ
             {
                 for (uint16_t i = 0; i < _pixelCount; i++)
                 {
-                    COLOR color = _colorWheel(((i * 256 / _pixelCount) + _counter_mode_step) & 0xFF);
+                    COLOR color = _colorWheel(((i * 256 / _pixelCount) + _fx.step) & 0xFF);
                     setPixel(i, color);
                 }
 
-                if ((_counter_mode_step = (_counter_mode_step + 1) & 0xFF) == 0xFF)
+                if ((_fx.step = (_fx.step + 1) & 0xFF) == 0xFF)
                     _isCycle = true;
                 return (_speed / 256);
             }
@@ -781,17 +913,17 @@ namespace EZ
             //
             uint16_t _modeFader(void)
             {
-                int lum = _counter_mode_step;
+                int lum = _fx.step;
 
                 if (lum > 255)
                     lum = 511 - lum; // lum = 0 -> 255 -> 0
 
                 fill(_helpBlend(_colors[1], _colors[2], lum));
 
-                _counter_mode_step += 4;
-                if (_counter_mode_step > 511)
+                _fx.step += 4;
+                if (_fx.step > 511)
                 {
-                    _counter_mode_step = 0;
+                    _fx.step = 0;
                     _isCycle = true;
                 }
                 return (_speed / 128);
@@ -805,8 +937,8 @@ namespace EZ
             //
             uint16_t _modeTheaterChaseRainbow(void)
             {
-                _counter_mode_step = (_counter_mode_step + 1) & 0xFF;
-                return _helpTheaterChase(_colorWheel(_counter_mode_step), EZ_COLOR_BLACK);
+                _fx.step = (_fx.step + 1) & 0xFF;
+                return _helpTheaterChase(_colorWheel(_fx.step), EZ_COLOR_BLACK);
             }
 
             // Blink several LEDs on, reset, repeat.
@@ -832,9 +964,9 @@ namespace EZ
             //
             uint16_t _modeSparkle(void)
             {
-                setPixel(_aux_param2, EZ_COLOR_BLACK);
-                _aux_param2 = random(_pixelCount); // aux_param3 stores the random led index
-                setPixel(_aux_param2, _colors[1]);
+                setPixel(_fx.aux2, EZ_COLOR_BLACK);
+                _fx.aux2 = random(_pixelCount); // aux_param3 stores the random led index
+                setPixel(_fx.aux2, _colors[1]);
                 return (_speed / _pixelCount);
             }
 
@@ -845,18 +977,15 @@ namespace EZ
             {
                 if (_counter_mode_call == 0)
                 {
-                    for (uint16_t i = 0; i < _pixelCount; i++)
-                    {
-                        setPixel(i, _colors[1]);
-                    }
+                    fill(_colors[1]);
                 }
 
-                setPixel(_aux_param2, _colors[1]);
+                setPixel(_fx.aux2, _colors[1]);
 
                 if (_random8(5) == 0)
                 {
-                    _aux_param2 = random(_pixelCount);
-                    setPixel(_aux_param2, EZ_COLOR_WHITE);
+                    _fx.aux2 = random(_pixelCount);
+                    setPixel(_fx.aux2, EZ_COLOR_WHITE);
                     return 20;
                 }
 
@@ -868,10 +997,7 @@ namespace EZ
             //
             uint16_t _modeHyperSparkle(void)
             {
-                for (uint16_t i = 0; i < _pixelCount; i++)
-                {
-                    setPixel(i, _colors[1]);
-                }
+                fill(_colors[1]);
 
                 if (_random8(5) < 2)
                 {
@@ -894,7 +1020,7 @@ namespace EZ
 
                 for (uint16_t i = 0; i < _pixelCount; i++)
                 {
-                    int lum = (int)sine8(((i + _counter_mode_step) * sineIncr));
+                    int lum = (int)sine8(((i + _fx.step) * sineIncr));
 
                     if (EZ_PIXEL_IS_REVERSE)
                     {
@@ -908,7 +1034,7 @@ namespace EZ
                     }
                 }
 
-                _counter_mode_step = (_counter_mode_step + 1) % 256;
+                _fx.step = (_fx.step + 1) % 256;
                 return (_speed / _pixelCount);
             }
 
@@ -930,21 +1056,21 @@ namespace EZ
                     }
                 }
 
-                if (_counter_mode_step == 0)
+                if (_fx.step == 0)
                 {
-                    _aux_param1 = _randomWheelIndex(_aux_param1);
+                    _fx.aux1 = _randomWheelIndex(_fx.aux1);
 
                     if (EZ_PIXEL_IS_REVERSE)
                     {
-                        setPixel(stop, _colorWheel(_aux_param1));
+                        setPixel(stop, _colorWheel(_fx.aux1));
                     }
                     else
                     {
-                        setPixel(0, _colorWheel(_aux_param1));
+                        setPixel(0, _colorWheel(_fx.aux1));
                     }
                 }
 
-                _counter_mode_step = (_counter_mode_step == 0) ? 1 : 0;
+                _fx.step = (_fx.step == 0) ? 1 : 0;
                 return (_speed / _pixelCount);
             }
 
@@ -957,16 +1083,16 @@ namespace EZ
             //
             uint16_t _modeScan(void)
             {
-                if (_counter_mode_step > (_pixelCount * 2) - 2)
+                if (_fx.step > (_pixelCount * 2) - 2)
                 {
-                    _counter_mode_step = 0;
+                    _fx.step = 0;
                     _isCycle = true;
                 }
 
                 fill(_colors[2]);
 
                 uint16_t stop = _pixelCount - 1;
-                uint16_t led_offset = _counter_mode_step - stop;
+                uint16_t led_offset = _fx.step - stop;
                 led_offset = abs(led_offset);
 
                 if (EZ_PIXEL_IS_REVERSE)
@@ -978,7 +1104,7 @@ namespace EZ
                     setPixel(led_offset, _colors[1]);
                 }
 
-                _counter_mode_step++;
+                _fx.step++;
                 return (_speed / (_pixelCount * 2));
             }
 
@@ -986,22 +1112,22 @@ namespace EZ
             //
             uint16_t _modeDualScan(void)
             {
-                if (_counter_mode_step > (_pixelCount * 2) - 2)
+                if (_fx.step > (_pixelCount * 2) - 2)
                 {
-                    _counter_mode_step = 0;
+                    _fx.step = 0;
                     _isCycle = true;
                 }
 
                 fill(_colors[2]);
 
                 uint16_t stop = _pixelCount - 1;
-                uint16_t led_offset = _counter_mode_step - stop;
+                uint16_t led_offset = _fx.step - stop;
                 led_offset = abs(led_offset);
 
                 setPixel(led_offset, _colors[1]);
                 setPixel(stop - led_offset, _colors[1]);
 
-                _counter_mode_step++;
+                _fx.step++;
                 return (_speed / (_pixelCount * 2));
             }
 
@@ -1012,32 +1138,32 @@ namespace EZ
                 _helpFadeOut();
                 uint16_t stop = _pixelCount - 1;
 
-                if (_counter_mode_step < _pixelCount)
+                if (_fx.step < _pixelCount)
                 {
                     if (EZ_PIXEL_IS_REVERSE)
                     {
-                        setPixel(stop - _counter_mode_step, _colors[1]);
+                        setPixel(stop - _fx.step, _colors[1]);
                     }
                     else
                     {
-                        setPixel(_counter_mode_step, _colors[1]);
+                        setPixel(_fx.step, _colors[1]);
                     }
                 }
                 else
                 {
                     if (EZ_PIXEL_IS_REVERSE)
                     {
-                        setPixel(stop - ((_pixelCount * 2) - _counter_mode_step) + 2, _colors[1]);
+                        setPixel(stop - ((_pixelCount * 2) - _fx.step) + 2, _colors[1]);
                     }
                     else
                     {
-                        setPixel(((_pixelCount * 2) - _counter_mode_step) - 2, _colors[1]);
+                        setPixel(((_pixelCount * 2) - _fx.step) - 2, _colors[1]);
                     }
                 }
 
-                _isCycle = (_counter_mode_step % _pixelCount == 0);
+                _isCycle = (_fx.step % _pixelCount == 0);
 
-                _counter_mode_step = (_counter_mode_step + 1) % ((_pixelCount * 2) - 2);
+                _fx.step = (_fx.step + 1) % ((_pixelCount * 2) - 2);
                 return (_speed / (_pixelCount * 2));
             }
 
@@ -1046,20 +1172,20 @@ namespace EZ
                 static int16_t dir = 1;
 
                 uint16_t stop = _pixelCount - 1;
-                _counter_mode_step += dir;
+                _fx.step += dir;
 
                 _helpFadeOut();
 
                 if (_options == EZ_PIXEL_OPTION_NONE)
                 {
-                    setPixel(_counter_mode_step, _colorWheel((_counter_mode_call++ % 8) * 32));
+                    setPixel(_fx.step, _colorWheel((_counter_mode_call++ % 8) * 32));
                 }
                 else
                 {
-                    setPixel(_counter_mode_step, _colorWheel((_counter_mode_step * 256) / _pixelCount));
+                    setPixel(_fx.step, _colorWheel((_fx.step * 256) / _pixelCount));
                 }
 
-                if (_counter_mode_step >= stop || _counter_mode_step <= 0)
+                if (_fx.step >= stop || _fx.step <= 0)
                     dir = -dir;
 
                 return (_speed / (_pixelCount * 2));
@@ -1069,12 +1195,12 @@ namespace EZ
             //
             uint16_t _modeICU(void)
             {
-                uint16_t dest = _counter_mode_step & 0xFFFF;
+                uint16_t dest = _fx.step & 0xFFFF;
 
                 setPixel(dest, _colors[1]);
                 setPixel(dest + _pixelCount / 2, _colors[1]);
 
-                if (_aux_param2 == dest)
+                if (_fx.aux2 == dest)
                 {
                     if (_random8(6) == 0)
                     {
@@ -1083,21 +1209,21 @@ namespace EZ
                         return 200;
                     }
 
-                    _aux_param2 = random(_pixelCount / 2);
+                    _fx.aux2 = random(_pixelCount / 2);
                     return 1000 + random(2000);
                 }
 
                 setPixel(dest, EZ_COLOR_BLACK);
                 setPixel(dest + _pixelCount / 2, EZ_COLOR_BLACK);
 
-                if (_aux_param2 > _counter_mode_step)
+                if (_fx.aux2 > _fx.step)
                 {
-                    _counter_mode_step++;
+                    _fx.step++;
                     dest++;
                 }
-                else if (_aux_param2 < _counter_mode_step)
+                else if (_fx.aux2 < _fx.step)
                 {
-                    _counter_mode_step--;
+                    _fx.step--;
                     dest--;
                 }
 
@@ -1111,26 +1237,26 @@ namespace EZ
             uint16_t _modeChaseColor(void) { return _helpChase(_colors[1], EZ_COLOR_WHITE, EZ_COLOR_WHITE); }
             uint16_t _modeChaseRandom(void)
             {
-                if (_counter_mode_step == 0)
+                if (_fx.step == 0)
                 {
-                    _aux_param1 = _randomWheelIndex(_aux_param1);
+                    _fx.aux1 = _randomWheelIndex(_fx.aux1);
                 }
-                return _helpChase(_colorWheel(_aux_param1), EZ_COLOR_WHITE, EZ_COLOR_WHITE);
+                return _helpChase(_colorWheel(_fx.aux1), EZ_COLOR_WHITE, EZ_COLOR_WHITE);
             }
 
             uint16_t _modeChaseRainbowWhite(void)
             {
                 uint8_t color_sep = 256 / _pixelCount;
                 uint8_t color_index = _counter_mode_call & 0xFF;
-                COLOR color = _colorWheel(((_counter_mode_step * color_sep) + color_index) & 0xFF);
+                COLOR color = _colorWheel(((_fx.step * color_sep) + color_index) & 0xFF);
 
                 return _helpChase(color, EZ_COLOR_WHITE, EZ_COLOR_WHITE);
             }
 
             uint16_t _modeChaseWhiteRainbow(void)
             {
-                uint16_t n = _counter_mode_step;
-                uint16_t m = (_counter_mode_step + 1) % _pixelCount;
+                uint16_t n = _fx.step;
+                uint16_t m = (_fx.step + 1) % _pixelCount;
                 COLOR color2 = _colorWheel(((n * 256 / _pixelCount) + (_counter_mode_call & 0xFF)) & 0xFF);
                 COLOR color3 = _colorWheel(((m * 256 / _pixelCount) + (_counter_mode_call & 0xFF)) & 0xFF);
 
@@ -1143,7 +1269,7 @@ namespace EZ
             {
                 uint8_t color_sep = 256 / _pixelCount;
                 uint8_t color_index = _counter_mode_call & 0xFF;
-                COLOR color = _colorWheel(((_counter_mode_step * color_sep) + color_index) & 0xFF);
+                COLOR color = _colorWheel(((_fx.step * color_sep) + color_index) & 0xFF);
 
                 return _helpChase(color, EZ_COLOR_BLACK, EZ_COLOR_BLACK);
             }
@@ -1161,8 +1287,8 @@ namespace EZ
                 {
                     if (flash_step % 2 == 0)
                     {
-                        uint16_t n = _counter_mode_step;
-                        uint16_t m = (_counter_mode_step + 1) % _pixelCount;
+                        uint16_t n = _fx.step;
+                        uint16_t m = (_fx.step + 1) % _pixelCount;
 
                         if (EZ_PIXEL_IS_REVERSE)
                         {
@@ -1183,7 +1309,7 @@ namespace EZ
                 }
                 else
                 {
-                    _counter_mode_step = (_counter_mode_step + 1) % _pixelCount;
+                    _fx.step = (_fx.step + 1) % _pixelCount;
                 }
 
                 return delay;
@@ -1197,17 +1323,17 @@ namespace EZ
                 const static uint8_t flash_count = 4;
                 uint8_t flash_step = _counter_mode_call % ((flash_count * 2) + 1);
 
-                for (uint16_t i = 0; i < _counter_mode_step; i++)
+                for (uint16_t i = 0; i < _fx.step; i++)
                 {
-                    setPixel(i, _colorWheel(_aux_param1));
+                    setPixel(i, _colorWheel(_fx.aux1));
                 }
 
                 uint16_t delay = (_speed / _pixelCount);
 
                 if (flash_step < (flash_count * 2))
                 {
-                    uint16_t n = _counter_mode_step;
-                    uint16_t m = (_counter_mode_step + 1) % _pixelCount;
+                    uint16_t n = _fx.step;
+                    uint16_t m = (_fx.step + 1) % _pixelCount;
 
                     if (flash_step % 2 == 0)
                     {
@@ -1217,18 +1343,18 @@ namespace EZ
                     }
                     else
                     {
-                        setPixel(n, _colorWheel(_aux_param1));
+                        setPixel(n, _colorWheel(_fx.aux1));
                         setPixel(m, EZ_COLOR_BLACK);
                         delay = 30;
                     }
                 }
                 else
                 {
-                    _counter_mode_step = (_counter_mode_step + 1) % _pixelCount;
+                    _fx.step = (_fx.step + 1) % _pixelCount;
 
-                    if (_counter_mode_step == 0)
+                    if (_fx.step == 0)
                     {
-                        _aux_param1 = _randomWheelIndex(_aux_param1);
+                        _fx.aux1 = _randomWheelIndex(_fx.aux1);
                     }
                 }
 
@@ -1251,14 +1377,14 @@ namespace EZ
                 if (EZ_PIXEL_IS_REVERSE)
                 {
                     uint16_t stop = _pixelCount - 1;
-                    setPixel(stop - _counter_mode_step, _colors[1]);
+                    setPixel(stop - _fx.step, _colors[1]);
                 }
                 else
                 {
-                    setPixel(_counter_mode_step, _colors[1]);
+                    setPixel(_fx.step, _colors[1]);
                 }
 
-                _counter_mode_step = (_counter_mode_step + 1) % _pixelCount;
+                _fx.step = (_fx.step + 1) % _pixelCount;
                 return (_speed / _pixelCount);
             }
 
@@ -1283,9 +1409,9 @@ namespace EZ
             {
                 _helpFadeOut();
 
-                // the new way, manipulate the Adafruit_NeoPixels pixels[] array directly, about 5x faster
-                uint8_t* pixels = _pixelData;
-                uint8_t pixelsPerLed = (_wOffset == _rOffset) ? 3 : 4;
+                // the new way, manipulate the pixels[] array directly, about 5x faster
+                uint8_t* pixels = (uint8_t*)_pixelData;
+                uint8_t pixelsPerLed = sizeof(COLOR);
                 uint16_t startPixel = pixelsPerLed + pixelsPerLed;
                 uint16_t stopPixel = (_pixelCount - 1) * pixelsPerLed;
 
@@ -1338,7 +1464,7 @@ namespace EZ
             //
             uint16_t _helpTriColorChase(COLOR color1, COLOR color2, COLOR color3)
             {
-                uint16_t index = _counter_mode_step % 6;
+                uint16_t index = _fx.step % 6;
                 uint16_t stop = _pixelCount - 1;
 
                 for (uint16_t i = 0; i < _pixelCount; i++, index++)
@@ -1363,7 +1489,7 @@ namespace EZ
                     }
                 }
 
-                _counter_mode_step++;
+                _fx.step++;
                 return (_speed / _pixelCount);
             }
 
@@ -1375,7 +1501,7 @@ namespace EZ
 
                 for (uint16_t i = 0; i <= stop; i++)
                 {
-                    if ((i + _counter_mode_step) % 4 < 2)
+                    if ((i + _fx.step) % 4 < 2)
                     {
                         if (EZ_PIXEL_IS_REVERSE)
                         {
@@ -1399,7 +1525,7 @@ namespace EZ
                     }
                 }
 
-                _counter_mode_step = (_counter_mode_step + 1) & 0x3;
+                _fx.step = (_fx.step + 1) & 0x3;
                 return (_speed / _pixelCount);
             }
 
@@ -1434,9 +1560,9 @@ namespace EZ
             {
                 uint16_t stop = _pixelCount - 1;
 
-                if (_counter_mode_step < _pixelCount)
+                if (_fx.step < _pixelCount)
                 {
-                    uint16_t led_offset = _counter_mode_step;
+                    uint16_t led_offset = _fx.step;
 
                     if (EZ_PIXEL_IS_REVERSE)
                     {
@@ -1449,7 +1575,7 @@ namespace EZ
                 }
                 else
                 {
-                    uint16_t led_offset = _counter_mode_step - _pixelCount;
+                    uint16_t led_offset = _fx.step - _pixelCount;
 
                     if ((EZ_PIXEL_IS_REVERSE && !rev) || (!EZ_PIXEL_IS_REVERSE && rev))
                     {
@@ -1461,10 +1587,10 @@ namespace EZ
                     }
                 }
 
-                if (_counter_mode_step % _pixelCount == 0)
+                if (_fx.step % _pixelCount == 0)
                     _isCycle = true;
 
-                _counter_mode_step = (_counter_mode_step + 1) % (_pixelCount * 2);
+                _fx.step = (_fx.step + 1) % (_pixelCount * 2);
 
                 return (_speed / (_pixelCount * 2));
             }
@@ -1528,21 +1654,18 @@ namespace EZ
             //
             uint16_t _helpTwinkle(COLOR color1, COLOR color2)
             {
-                if (_counter_mode_step == 0)
+                if (_fx.step == 0)
                 {
-                    for (uint16_t i = 0; i < _pixelCount; i++)
-                    {
-                        setPixel(i, color2);
-                    }
+                    fill(color2);
 
                     uint16_t min_leds = max(1, _pixelCount / 5); // make sure, at least one LED is on
                     uint16_t max_leds = max(1, _pixelCount / 2); // make sure, at least one LED is on
-                    _counter_mode_step = random(min_leds, max_leds);
+                    _fx.step = random(min_leds, max_leds);
                 }
 
                 setPixel(random(_pixelCount), color1);
 
-                _counter_mode_step--;
+                _fx.step--;
                 return (_speed / _pixelCount);
             }
 
@@ -1567,7 +1690,7 @@ namespace EZ
             uint16_t _helpChase(COLOR color1, COLOR color2, COLOR color3)
             {
                 uint16_t stop = _pixelCount - 1;
-                uint16_t a = _counter_mode_step;
+                uint16_t a = _fx.step;
                 uint16_t b = (a + 1) % _pixelCount;
                 uint16_t c = (b + 1) % _pixelCount;
 
@@ -1589,7 +1712,7 @@ namespace EZ
                 else
                     _isCycle = false;
 
-                _counter_mode_step = (_counter_mode_step + 1) % _pixelCount;
+                _fx.step = (_fx.step + 1) % _pixelCount;
                 return (_speed / _pixelCount);
             }
 
@@ -1605,41 +1728,15 @@ namespace EZ
                 uint8_t rateH = rateMapH[rate];
                 uint8_t rateL = rateMapL[rate];
 
-                for (uint16_t i = 0; i < _pixelCount; i++)
-                {
-                    COLOR color = getPixel(i);
-
-                    if (rate == 0)
-                    {
-                        // old fade-to-black algorithm
-                        // setPixel(i, (color.u >> 1) & 0x7F7F7F7F);
+                if (!_pixelData)
+                    return;
 
-                        color.r >>= 1 & 0x7F;
-                        color.g >>= 1 & 0x7F;
-                        color.b >>= 1 & 0x7F;
-                        color.w >>= 1 & 0x7F;
+                if (rate == 0)
+                    PIXEL::scale(_pixelData, _pixelCount, 128); // old fade-to-black algorithm
+                else
+                    PIXEL::fade(_pixelData, _pixelCount, target, rateH, rateL);
 
-                        setPixel(i, color);
-                    }
-                    else
-                    {
-                        // new fade-to-color algorithm
-                        // calculate the color differences between the current and target colors
-                        uint8_t wdelta = target.w - color.w;
-                        uint8_t rdelta = target.r - color.r;
-                        uint8_t gdelta = target.g - color.g;
-                        uint8_t bdelta = target.b - color.b;
-
-                        // if the current and target colors are almost the same, jump right to the target color,
-                        // otherwise calculate an intermediate color. (fixes rounding issues)
-                        wdelta = abs(wdelta) < 3 ? wdelta : (wdelta >> rateH) + (wdelta >> rateL);
-                        rdelta = abs(rdelta) < 3 ? rdelta : (rdelta >> rateH) + (rdelta >> rateL);
-                        gdelta = abs(gdelta) < 3 ? gdelta : (gdelta >> rateH) + (gdelta >> rateL);
-                        bdelta = abs(bdelta) < 3 ? bdelta : (bdelta >> rateH) + (bdelta >> rateL);
-
-                        setPixel(i, color.r + rdelta, color.g + gdelta, color.b + bdelta, color.w + wdelta);
-                    }
-                }
+                _setDirty();
             }
 
             // Color Wheel
@@ -1736,7 +1833,19 @@ namespace EZ
             {
                 if (_pixelData)
                 {
-                    _pixelData = _memFree(_pixelData);
+                    _pixelData = (COLOR*)_memFree((uint8_t*)_pixelData);
+                }
+
+                if (_wireData)
+                {
+                    free(_wireData);
+                    _wireData = nullptr;
+                }
+
+                if (_ownerData && _rootHandler() == this)
+                {
+                    free(_ownerData);
+                    _ownerData = nullptr;
                 }
 
                 if (_pixelOrder != ORDER::MONO)
@@ -1749,9 +1858,9 @@ namespace EZ
                 _pixelBits = 8 * _pixelSize;
                 _pixelBytes = _pixelSize * n;
 
-                if ((_pixelData = _memAlloc(_pixelBytes)))
+                if ((_pixelData = (COLOR*)_memAlloc(n * sizeof(COLOR))))
                 {
-                    memset(_pixelData, 0, _pixelBytes);
+                    memset((uint8_t*)_pixelData, 0, n * sizeof(COLOR));
                     _pixelCount = n;
                 }
                 else
@@ -0,0 +1,171 @@
+/*
+** EZIoT - Pixel Bulk Kernels
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_PIXEL_KERNELS_H
+#define _EZ_PIXEL_KERNELS_H
+#include "core/tool/ez_color.h"
+
+namespace EZ
+{
+    namespace PIXEL
+    {
+        /*
+        ** Bulk pixel kernels
+        **
+        ** Whole buffer operations on logical pixels (COLOR, one 32-bit word per pixel), SIMD within
+        ** a register: channels are split into two 0x00FF00FF halves, giving each byte 8 bits of
+        ** headroom for a multiply or a borrow, so a pixel costs a handful of word operations
+        ** whatever its color order. The loops are simple enough for a host compiler to vectorize.
+        **
+        ** dst may be the same buffer as a source.
+        */
+        static const uint32_t SWAR_LO = 0x00FF00FF;
+        static const uint32_t SWAR_HI = 0x80808080;
+
+        static inline void fill(COLOR* dst, size_t n, COLOR c)
+        {
+            uint32_t* d = &dst->u;
+            uint32_t u = c.u;
+
+            for (size_t i = 0; i < n; i++)
+                d[i] = u;
+        }
+
+        // Each channel times level / 256, level 256 leaves the pixels unchanged
+        //
+        static inline void scale(COLOR* dst, size_t n, uint16_t level)
+        {
+            uint32_t* d = &dst->u;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                uint32_t x = d[i];
+                uint32_t lo = ((x & SWAR_LO) * level) >> 8;
+                uint32_t hi = ((x >> 8) & SWAR_LO) * level;
+
+                d[i] = (lo & SWAR_LO) | (hi & ~SWAR_LO);
+            }
+        }
+
+        // dst = a + (b - a) * alpha / 255, per channel (alpha 0 is a, 255 is b)
+        //
+        static inline void blend(COLOR* dst, const COLOR* a, const COLOR* b, size_t n, uint8_t alpha)
+        {
+            uint32_t wb = alpha + (alpha >> 7);
+            uint32_t wa = 256 - wb;
+            uint32_t* d = &dst->u;
+            const uint32_t* pa = &a->u;
+            const uint32_t* pb = &b->u;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                uint32_t x = pa[i];
+                uint32_t y = pb[i];
+                uint32_t lo = (((x & SWAR_LO) * wa + (y & SWAR_LO) * wb) >> 8) & SWAR_LO;
+                uint32_t hi = (((x >> 8) & SWAR_LO) * wa + ((y >> 8) & SWAR_LO) * wb) & ~SWAR_LO;
+
+                d[i] = lo | hi;
+            }
+        }
+
+        // dst = min(dst + src, 255), per channel
+        //
+        static inline void add(COLOR* dst, const COLOR* src, size_t n)
+        {
+            uint32_t* d = &dst->u;
+            const uint32_t* ps = &src->u;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                uint32_t x = d[i];
+                uint32_t y = ps[i];
+                uint32_t s = ((x & ~SWAR_HI) + (y & ~SWAR_HI)) ^ ((x ^ y) & SWAR_HI);
+                uint32_t carry = ((x & y) | ((x | y) & ~s)) & SWAR_HI;
+
+                d[i] = s | ((carry >> 7) * 0xFF);
+            }
+        }
+
+        // dst = dst * src / 256, per channel (src 255 leaves dst unchanged). Channels carry different
+        // factors, so this one goes a byte at a time.
+        //
+        static inline void multiply(COLOR* dst, const COLOR* src, size_t n)
+        {
+            uint8_t* d = dst->q;
+            const uint8_t* s = src->q;
+
+            for (size_t i = 0; i < n * sizeof(COLOR); i++)
+                d[i] = (d[i] * (s[i] + 1)) >> 8;
+        }
+
+        // dst = blend(dst, src) keyed on src, each pixel's alpha is its brightest channel times
+        // opacity / 255, so black is transparent and a full bright channel is opaque
+        //
+        static inline void over(COLOR* dst, const COLOR* src, size_t n, uint8_t opacity)
+        {
+            uint32_t op = opacity + (opacity >> 7);
+            uint32_t* d = &dst->u;
+            const uint32_t* ps = &src->u;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                uint32_t x = d[i];
+                uint32_t y = ps[i];
+                uint32_t m = max(max(y & 0xFF, (y >> 8) & 0xFF), max((y >> 16) & 0xFF, y >> 24));
+                uint32_t wb = ((m + (m >> 7)) * op) >> 8;
+                uint32_t wa = 256 - wb;
+                uint32_t lo = (((x & SWAR_LO) * wa + (y & SWAR_LO) * wb) >> 8) & SWAR_LO;
+                uint32_t hi = (((x >> 8) & SWAR_LO) * wa + ((y >> 8) & SWAR_LO) * wb) & ~SWAR_LO;
+
+                d[i] = lo | hi;
+            }
+        }
+
+        // Move two 0x00FF00FF lanes of c toward t, see fade()
+        //
+        static inline uint32_t __fadeLanes(uint32_t c, uint32_t t, uint8_t shiftH, uint8_t shiftL)
+        {
+            // 9-bit lanes: bit 8 set where target >= current
+            uint32_t up = (t | 0x01000100) - c;
+            uint32_t dn = (c | 0x01000100) - t;
+            uint32_t ge = ((up >> 8) & 0x00010001) * 0xFF;
+            uint32_t d = (up & ge) | (dn & ~ge & SWAR_LO);
+
+            // Within 2 of the target, go straight there
+            uint32_t far = (((d + 0x00FD00FD) >> 8) & 0x00010001) * 0xFF;
+            uint32_t step = ((((d >> shiftH) & SWAR_LO) + ((d >> shiftL) & SWAR_LO)) & far) | (d & ~far);
+
+            return c + (step & ge) - (step & ~ge & SWAR_LO);
+        }
+
+        // Move each channel toward target by (d >> shiftH) + (d >> shiftL) of the distance d, or
+        // straight to it when it is within 2. Never overshoots.
+        //
+        static inline void fade(COLOR* dst, size_t n, COLOR target, uint8_t shiftH, uint8_t shiftL)
+        {
+            uint32_t tlo = target.u & SWAR_LO;
+            uint32_t thi = (target.u >> 8) & SWAR_LO;
+            uint32_t* d = &dst->u;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                uint32_t x = d[i];
+                uint32_t lo = __fadeLanes(x & SWAR_LO, tlo, shiftH, shiftL);
+                uint32_t hi = __fadeLanes((x >> 8) & SWAR_LO, thi, shiftH, shiftL);
+
+                d[i] = lo | (hi << 8);
+            }
+        }
+    } // namespace PIXEL
+} // namespace EZ
+#endif // _EZ_PIXEL_KERNELS_H
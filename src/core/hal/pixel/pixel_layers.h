@@ -0,0 +1,324 @@
+/*
+** EZIoT - Pixel Layer Compositor
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_PIXEL_LAYERS_H
+#define _EZ_PIXEL_LAYERS_H
+#include "pixel_handler.h"
+#include "pixel_kernels.h"
+
+namespace EZ
+{
+    namespace PIXEL
+    {
+        class COMPOSITOR;
+
+        /*
+        ** LAYER - A handler with its own pixel buffer, merged over a range of the compositor's
+        ** target by the compositor, in the order the layers were created.
+        **
+        ** REPLACE  : the layer's pixels
+        ** ADD      : added to what is below, saturating
+        ** MULTIPLY : what is below times the layer (white leaves it, black blanks it)
+        ** ALPHA    : keyed, each pixel's brightest channel is its alpha (black is transparent)
+        **
+        ** Opacity (and the layer's level, so on/off fades the layer) weights every mode. A layer
+        ** that is off contributes nothing.
+        */
+        class LAYER : public HANDLER
+        {
+        public:
+            friend class COMPOSITOR;
+
+            typedef enum BLEND
+            {
+                REPLACE = 0,
+                ADD,
+                MULTIPLY,
+                ALPHA
+            } blend_t;
+
+            LAYER(COMPOSITOR& comp, uint16_t offset, uint16_t count, blend_t mode = REPLACE, uint8_t opacity = 255);
+            ~LAYER();
+
+            blend_t getBlend(void) { return _blend; }
+            void setBlend(blend_t mode)
+            {
+                _blend = mode;
+                _setDirty();
+            }
+
+            uint8_t getOpacity(void) { return _opacity; }
+            void setOpacity(uint8_t opacity)
+            {
+                _opacity = opacity;
+                _setDirty();
+            }
+
+            uint16_t offset(void) { return _offset; }
+
+        protected:
+            COMPOSITOR* _comp;
+            LAYER* _nextLayer;
+            uint16_t _offset;
+            blend_t _blend;
+            uint8_t _opacity;
+            uint8_t _onState; // State at the last merge
+
+            bool _changed(void) { return _isDirty || _onState != getState(); }
+
+            // Opacity with the layer's level applied, 0 if the layer is off
+            uint8_t _weight(void)
+            {
+                if (getState() == EZ_PIXEL_STATE_OFF)
+                    return 0;
+
+                return _pixelLevel ? (_opacity * _pixelLevel) >> 8 : _opacity;
+            }
+
+            // Merge into dst, clipped to count pixels (the target may have been re-sized since)
+            //
+            void _merge(COLOR* dst, uint16_t count)
+            {
+                static const uint16_t CHUNK = 32;
+
+                uint8_t weight = _weight();
+                COLOR* src = _pixelData;
+                COLOR tmp[CHUNK];
+
+                _isDirty = false;
+                _onState = getState();
+
+                if (!src || !weight || _offset >= count)
+                    return;
+
+                uint16_t pixels = min(_pixelCount, (uint16_t)(count - _offset));
+
+                dst += _offset;
+
+                switch (_blend)
+                {
+                case REPLACE:
+                    PIXEL::blend(dst, dst, src, pixels, weight);
+                    break;
+
+                case ALPHA:
+                    PIXEL::over(dst, src, pixels, weight);
+                    break;
+
+                case ADD:
+                case MULTIPLY:
+                    for (uint16_t n = 0; n < pixels; n += CHUNK)
+                    {
+                        uint16_t len = min((uint16_t)(pixels - n), CHUNK);
+
+                        if (_blend == ADD)
+                        {
+                            memcpy(tmp, &src[n], len * sizeof(COLOR));
+                            PIXEL::scale(tmp, len, weight + (weight >> 7));
+                            PIXEL::add(&dst[n], tmp, len);
+                        }
+                        else
+                        {
+                            memcpy(tmp, &dst[n], len * sizeof(COLOR));
+                            PIXEL::multiply(tmp, &src[n], len);
+                            PIXEL::blend(&dst[n], &dst[n], tmp, len, weight);
+                        }
+                    }
+                    break;
+                }
+            }
+
+        private:
+            LAYER(LAYER const& copy);            // Not Implemented
+            LAYER& operator=(LAYER const& copy); // Not Implemented
+        };
+
+        /*
+        ** COMPOSITOR - Owns the pixels of a target handler (usually a NEO::STRAND) and rebuilds
+        ** them from its layers. Call service() in place of the layers' own service(), then render
+        ** the target as usual.
+        **
+        ** Only layers at and above the lowest changed layer are merged each frame, those below it
+        ** are kept merged in a base buffer, so a static background costs nothing while an effect
+        ** animates over it.
+        */
+        class COMPOSITOR
+        {
+        public:
+            friend class LAYER;
+
+            COMPOSITOR(HANDLER& target)
+                : _target(&target), _headLayer(nullptr), _base(nullptr), _baseCount(0), _cached(0), _changed(true)
+            {
+            }
+
+            ~COMPOSITOR()
+            {
+                while (_headLayer)
+                    _remove(_headLayer);
+
+                if (_base)
+                    free(_base);
+            }
+
+            // Service every layer, then merge if any changed. Returns true if the target changed.
+            //
+            bool service(void)
+            {
+                for (LAYER* layer = _headLayer; layer; layer = layer->_nextLayer)
+                    layer->service();
+
+                return compose();
+            }
+
+            bool compose(void)
+            {
+                uint16_t count = _target->pixels();
+                uint16_t first = 0;
+                LAYER* layer;
+
+                if (!_target->_pixelData || !count)
+                    return false;
+
+                // The target can be re-sized under us, the base follows it
+                if (!_base || _baseCount != count)
+                {
+                    COLOR* base = (COLOR*)realloc(_base, count * sizeof(COLOR));
+
+                    if (!base)
+                        return false;
+                    _base = base;
+                    _baseCount = count;
+                    _changed = true;
+                }
+
+                // Lowest changed layer
+                for (layer = _headLayer; layer && !layer->_changed(); layer = layer->_nextLayer)
+                    first++;
+
+                if (!layer && !_changed)
+                    return false;
+
+                // Bring the base up to just below it
+                if (_changed || first < _cached)
+                {
+                    PIXEL::fill(_base, count, EZ_COLOR_BLACK);
+                    _cached = 0;
+                }
+
+                layer = _layer(_cached);
+
+                for (; _cached < first; _cached++, layer = layer->_nextLayer)
+                    layer->_merge(_base, count);
+
+                // Then everything above it over a copy
+                memcpy(_target->_pixelData, _base, count * sizeof(COLOR));
+
+                for (; layer; layer = layer->_nextLayer)
+                    layer->_merge(_target->_pixelData, count);
+
+                _changed = false;
+                _target->_setDirty();
+                return true;
+            }
+
+            uint8_t layers(void)
+            {
+                uint8_t n = 0;
+
+                for (LAYER* layer = _headLayer; layer; layer = layer->_nextLayer)
+                    n++;
+                return n;
+            }
+
+            HANDLER& target(void) { return *_target; }
+
+        protected:
+            HANDLER* _target;
+            LAYER* _headLayer;
+            COLOR* _base;     // Merge of the bottom _cached layers
+            uint16_t _baseCount; // Pixels allocated for it
+            uint8_t _cached;
+            bool _changed;    // Layers added or removed
+
+            LAYER* _layer(uint8_t n)
+            {
+                LAYER* layer = _headLayer;
+
+                while (layer && n--)
+                    layer = layer->_nextLayer;
+                return layer;
+            }
+
+            void _add(LAYER* layer)
+            {
+                LAYER** tail = &_headLayer;
+
+                while (*tail)
+                    tail = &(*tail)->_nextLayer;
+
+                *tail = layer;
+                layer->_nextLayer = nullptr;
+                _changed = true;
+            }
+
+            void _remove(LAYER* layer)
+            {
+                for (LAYER** l = &_headLayer; *l; l = &(*l)->_nextLayer)
+                {
+                    if (*l == layer)
+                    {
+                        *l = layer->_nextLayer;
+                        break;
+                    }
+                }
+
+                layer->_comp = nullptr;
+                _changed = true;
+            }
+
+        private:
+            COMPOSITOR(COMPOSITOR const& copy);            // Not Implemented
+            COMPOSITOR& operator=(COMPOSITOR const& copy); // Not Implemented
+        };
+
+        inline LAYER::LAYER(COMPOSITOR& comp, uint16_t offset, uint16_t count, blend_t mode, uint8_t opacity)
+            : HANDLER(comp.target()._pixelOrder, 0), _comp(&comp), _nextLayer(nullptr), _offset(offset),
+              _blend(mode), _opacity(opacity), _onState(EZ_PIXEL_STATE_OFF)
+        {
+            uint16_t pixels = comp.target().pixels();
+
+            // Clip to the target
+            if (_offset >= pixels)
+                _offset = count = 0;
+            else if (count > pixels - _offset)
+                count = pixels - _offset;
+
+            if (count)
+            {
+                __pixelOrder(comp.target()._pixelOrder);
+                __pixelCount(count);
+                clear();
+            }
+
+            comp._add(this);
+        }
+
+        inline LAYER::~LAYER()
+        {
+            if (_comp)
+                _comp->_remove(this);
+        }
+    } // namespace PIXEL
+} // namespace EZ
+#endif // _EZ_PIXEL_LAYERS_H
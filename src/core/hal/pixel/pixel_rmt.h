@@ -0,0 +1,71 @@
+/*
+** EZIoT - Pixel RMT Symbol Encoder
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_PIXEL_RMT_H
+#define _EZ_PIXEL_RMT_H
+#include <stddef.h>
+#include <stdint.h>
+
+// rmtEncode() runs in the RMT refill interrupt, so lives in IRAM on target (no-op on a host)
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+namespace EZ
+{
+    namespace PIXEL
+    {
+        /*
+        ** RMT symbol encoder
+        **
+        ** Each pixel byte goes out as 8 RMT symbols, MSB first. A table of the 4 symbols for every
+        ** nibble value is built once per strand from its '0' and '1' pulses, so encoding a byte is
+        ** two lookups and 8 word stores rather than a shift and test per bit.
+        **
+        ** No hardware dependencies, so these can be tested and benchmarked on a host.
+        */
+        typedef uint32_t rmt_table_t[16][4];
+
+        static inline void rmtTable(rmt_table_t table, uint32_t zero, uint32_t one)
+        {
+            for (int n = 0; n < 16; n++)
+            {
+                for (int b = 0; b < 4; b++)
+                    table[n][b] = (n & (0x08 >> b)) ? one : zero;
+            }
+        }
+
+        // len bytes of src into len * 8 symbols at dst (the RMT channel memory on target)
+        //
+        static inline IRAM_ATTR void rmtEncode(volatile uint32_t* dst, const uint8_t* src, size_t len,
+                                               const rmt_table_t table)
+        {
+            while (len--)
+            {
+                const uint32_t* hi = table[*src >> 4];
+                const uint32_t* lo = table[*src++ & 0x0F];
+
+                dst[0] = hi[0];
+                dst[1] = hi[1];
+                dst[2] = hi[2];
+                dst[3] = hi[3];
+                dst[4] = lo[0];
+                dst[5] = lo[1];
+                dst[6] = lo[2];
+                dst[7] = lo[3];
+                dst += 8;
+            }
+        }
+    } // namespace PIXEL
+} // namespace EZ
+#endif // _EZ_PIXEL_RMT_H
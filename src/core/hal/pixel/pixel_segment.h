@@ -14,6 +14,7 @@
 #ifndef _EZ_PIXEL_SEGMENT_H
 #define _EZ_PIXEL_SEGMENT_H
 #include "pixel_handler.h"
+#include <utility>
 
 namespace EZ
 {
@@ -30,16 +31,42 @@ namespace EZ
                 {
                     if (count)
                     {
+                        HANDLER* root = pxb._rootHandler();
+
                         __pixelOrder(pxb._pixelOrder);
                         __pixelCount(count);
+
+                        // Pixels we write are output at our level, tracked in the root's owner map
+                        if (_pixelData && (_ownerId = root->_ownerNext()))
+                            _ownerData = &root->_ownerData[_pixelData - root->_pixelData];
                         clear();
                     }
                 }
                 else
                     _pixelOffset = _pixelCount = 0;
+
+                // Register with the parent, so its output stage finds the pixels we own
+                _nextSegment = pxb._headSegment;
+                pxb._headSegment = this;
             }
 
-            ~SEGMENT() {}
+            ~SEGMENT()
+            {
+                for (HANDLER** seg = &_pixelBuffer->_headSegment; *seg; seg = &(*seg)->_nextSegment)
+                {
+                    if (*seg == this)
+                    {
+                        *seg = _nextSegment;
+                        break;
+                    }
+                }
+
+                // Our pixels go back to the parent, don't let ~HANDLER() free them
+                if (_ownerData)
+                    memset(_ownerData, _pixelBuffer->_ownerId, _pixelCount);
+                _ownerData = nullptr;
+                _pixelData = nullptr;
+            }
 
         protected:
             HANDLER* _pixelBuffer;
@@ -53,15 +80,106 @@ namespace EZ
 
             uint8_t* _memAlloc(size_t size)
             {
-                return _pixelBuffer ? &_pixelBuffer->_pixelData[_pixelSize * _pixelOffset] : nullptr;
+                return _pixelBuffer ? (uint8_t*)&_pixelBuffer->_pixelData[_pixelOffset] : nullptr;
             }
 
             uint8_t* _memFree(uint8_t* mem) { return nullptr; }
 
+            HANDLER* _rootHandler(void) { return _pixelBuffer->_rootHandler(); }
+
         private:
             SEGMENT(SEGMENT const& copy);            // Not Implemented
             SEGMENT& operator=(SEGMENT const& copy); // Not Implemented
         };
+
+        /*
+        ** VIEW - Lightweight segment
+        **
+        ** Runs its own effect over a range of a handler's pixels, sharing the handler's colors, speed,
+        ** options and level. Holds only the range and the effect's state, so a strand can be carved
+        ** into many views for the price of one SEGMENT. Call service() from the same loop that
+        ** services the handler, after it, so views draw over the handler's own effect.
+        */
+        class VIEW
+        {
+        public:
+            VIEW(uint16_t offset, uint16_t length, uint8_t mode = EZ_PIXEL_DEFAULT_MODE)
+                : _offset(offset), _length(length), _mode(0)
+            {
+                setMode(mode);
+            }
+
+            uint16_t offset(void) const { return _offset; }
+            uint16_t length(void) const { return _length; }
+            uint8_t getMode(void) const { return _mode; }
+            bool isCycle(void) const { return _cycle; }
+
+            void setMode(uint8_t mode)
+            {
+                _mode = constrain(mode, 0, MODE_COUNT - 1);
+                _cycle = false;
+                _frames = 0;
+                _next = millis();
+                memset(_state, 0, sizeof(_state));
+            }
+
+            // Run a frame if one is due, returns true if it did. Views only run while the handler
+            // is on, and are clipped to its pixels.
+            //
+            bool service(HANDLER& pixels)
+            {
+                uint32_t now = millis();
+
+                if (pixels._state != EZ_PIXEL_STATE_ON || !pixels._pixelData || _offset >= pixels._pixelCount ||
+                    (int32_t)(now - _next) < 0)
+                    return false;
+
+                COLOR* data = pixels._pixelData;
+                uint8_t* owners = pixels._ownerData;
+                uint16_t count = pixels._pixelCount;
+
+                pixels._pixelData += _offset;
+                if (owners)
+                    pixels._ownerData += _offset;
+                pixels._pixelCount = min(_length, (uint16_t)(count - _offset));
+                _swap(pixels);
+
+                pixels._isCycle = false;
+                uint16_t delay = pixels._frame();
+                _next = now + max(delay, EZ_PIXEL_SPEED_MIN);
+
+                _swap(pixels);
+                pixels._pixelData = data;
+                pixels._ownerData = owners;
+                pixels._pixelCount = count;
+                return true;
+            }
+
+        protected:
+            uint16_t _offset;
+            uint16_t _length;
+            uint8_t _mode;
+            bool _cycle;
+            uint32_t _frames;
+            uint32_t _next;
+            alignas(8) uint8_t _state[EZ_PIXEL_FX_STATE];
+
+            // Trade effect state with the handler, it runs the frame as if the range were all its pixels
+            //
+            void _swap(HANDLER& pixels)
+            {
+                uint8_t state[EZ_PIXEL_FX_STATE];
+
+                memcpy(state, pixels._fxState, sizeof(state));
+                memcpy(pixels._fxState, _state, sizeof(state));
+                memcpy(_state, state, sizeof(state));
+                std::swap(_mode, pixels._mode);
+                std::swap(_cycle, pixels._isCycle);
+                std::swap(_frames, pixels._counter_mode_call);
+            }
+        };
+
+        static_assert(sizeof(VIEW) <= 32, "VIEW has outgrown its footprint");
     } // namespace PIXEL
 } // namespace EZ
 #endif // _EZ_PIXEL_SEGMENT_H
\ No newline at end of file
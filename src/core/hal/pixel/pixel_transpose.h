@@ -0,0 +1,112 @@
+/*
+** EZIoT - Pixel Bit-Plane Transposition
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_PIXEL_TRANSPOSE_H
+#define _EZ_PIXEL_TRANSPOSE_H
+#include <stddef.h>
+#include <stdint.h>
+
+namespace EZ
+{
+    namespace PIXEL
+    {
+        /*
+        ** Parallel output kernels
+        **
+        ** A parallel bus (e.g. I2S in LCD mode) drives one strand per data line, so each sample
+        ** carries the same bit of every strand's byte stream. Turning N byte streams into those
+        ** samples is an 8x8 bit matrix transpose per 8 lanes, done here a word at a time.
+        **
+        ** No hardware dependencies, so these can be tested and benchmarked on a host.
+        */
+        static const uint8_t MAX_LANES = 16;
+
+        // Transpose an 8x8 bit matrix held in two words (Hacker's Delight, 7-3). Row r is byte
+        // (3 - r % 4) of x (r < 4) or y (r >= 4), the transposed rows come back the same way.
+        //
+        static inline void transpose8(uint32_t& x, uint32_t& y)
+        {
+            uint32_t t;
+
+            t = (x ^ (x >> 7)) & 0x00AA00AA;
+            x = x ^ t ^ (t << 7);
+            t = (y ^ (y >> 7)) & 0x00AA00AA;
+            y = y ^ t ^ (t << 7);
+
+            t = (x ^ (x >> 14)) & 0x0000CCCC;
+            x = x ^ t ^ (t << 14);
+            t = (y ^ (y >> 14)) & 0x0000CCCC;
+            y = y ^ t ^ (t << 14);
+
+            t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+            y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+            x = t;
+        }
+
+        // One byte from each of 16 lanes into 8 bit planes, MSB first. Bit n of plane[k] is
+        // bit (7 - k) of lane[n].
+        //
+        static inline void transpose16(const uint8_t lane[MAX_LANES], uint16_t plane[8])
+        {
+            // Lane 7 (15) as the top row puts lane n at bit n of each plane
+            uint32_t x0 = ((uint32_t)lane[7] << 24) | (lane[6] << 16) | (lane[5] << 8) | lane[4];
+            uint32_t y0 = ((uint32_t)lane[3] << 24) | (lane[2] << 16) | (lane[1] << 8) | lane[0];
+            uint32_t x1 = ((uint32_t)lane[15] << 24) | (lane[14] << 16) | (lane[13] << 8) | lane[12];
+            uint32_t y1 = ((uint32_t)lane[11] << 24) | (lane[10] << 16) | (lane[9] << 8) | lane[8];
+
+            transpose8(x0, y0);
+            transpose8(x1, y1);
+
+            for (int k = 0; k < 4; k++)
+            {
+                int shift = 24 - 8 * k;
+
+                plane[k] = (((x1 >> shift) & 0xFF) << 8) | ((x0 >> shift) & 0xFF);
+                plane[k + 4] = (((y1 >> shift) & 0xFF) << 8) | ((y0 >> shift) & 0xFF);
+            }
+        }
+
+        // Encode len bytes of up to 16 lanes (data[n], count[n] bytes long, shorter lanes are
+        // padded with 0) as 3 samples per bit, high / data / low, the NRZ shape WS281x parts
+        // expect when the samples are clocked at 3x the bit rate. Only lanes in mask are driven
+        // high. The bus takes 16-bit samples in swapped pairs, so sample i is written to out[i ^ 1].
+        //
+        // Returns the samples written, len * 24.
+        //
+        static inline size_t encodeParallel(uint16_t* out, const uint8_t* const data[], const size_t count[],
+                                            uint8_t lanes, size_t len, uint16_t mask)
+        {
+            uint8_t lane[MAX_LANES] = {0};
+            uint16_t plane[8];
+            size_t i = 0;
+
+            for (size_t b = 0; b < len; b++)
+            {
+                for (uint8_t n = 0; n < lanes && n < MAX_LANES; n++)
+                    lane[n] = (b < count[n]) ? data[n][b] : 0;
+
+                transpose16(lane, plane);
+
+                for (int k = 0; k < 8; k++)
+                {
+                    out[i++ ^ 1] = mask;
+                    out[i++ ^ 1] = plane[k] & mask;
+                    out[i++ ^ 1] = 0;
+                }
+            }
+
+            return i;
+        }
+    } // namespace PIXEL
+} // namespace EZ
+#endif // _EZ_PIXEL_TRANSPOSE_H
@@ -41,6 +41,14 @@ namespace EZ
             UPDATE
         } ssdp_method_t;
 
+        typedef struct
+        {
+            uint32_t searches;   // M-SEARCH requests received
+            uint32_t duplicates; // ...ignored as a repeat within the MX window
+            uint32_t replies;    // Search responses sent
+            uint32_t throttled;  // ...suppressed by the per-source rate limit
+        } ssdp_stats_t;
+
         typedef enum
         {
             OTAU_STOPPED,
@@ -75,11 +83,18 @@ namespace EZ
         void otauCredentials(const char* pass, uint16_t port = EZ_OTAU_PORT);
         void otauPort(uint16_t port) { _otauPort.native(port); }
 
+        void nvsPersist(uint32_t debounce, uint32_t maxLatency = EZ_NVS_MAX_LATENCY);
+
         void mdnsInstance(String name);
         void mdnsService(const char* name, const char* proto, uint16_t port, const char* instName = nullptr,
                          mdns_txt_item_t* txt = nullptr, int len = 0);
         void mdnsServiceTxt(const char* name, const char* proto, const char* key, const char* value);
         void mdnsRemove(const char* name, const char* proto);
+        void dnssdDevices(bool publish) { _dnssdDevices = publish; }
+
+        const ssdp_stats_t& ssdpStats(void) { return _ssdpStats; }
+        uint32_t ssdpBootId(void) { return _ssdpBootId; }
+        uint32_t ssdpConfigId(void) { return _ssdpConfigId; }
 
         ROOT root;
         CONSOLE& console;
@@ -95,11 +110,18 @@ namespace EZ
         bool _needRestart;
         bool _wpsConfig;
         bool _smartConfig;
+        bool _dnssdDevices;
+        bool _dnssdPublished; // Devices currently published by DNS-SD
 
         wps_type_t _wpsType;
         unsigned long _wpsTimeout;
         unsigned long _wifiTimeout;
         unsigned int _ssdpAdvertAge;
+        uint32_t _nvsDebounce;
+        uint32_t _nvsMaxLatency;
+        uint32_t _ssdpBootId;
+        uint32_t _ssdpConfigId;
+        uint32_t _ssdpConfigSeen; // Configuration version CONFIGID was computed at
 
         AsyncUDP _ssdpUDP;
         AsyncUDP _otauUDP;
@@ -114,6 +136,52 @@ namespace EZ
         String _otauOnce;
         int _nodeCount;
 
+        // SSDP search target index, built when SSDP starts so that M-SEARCH
+        // requests can be matched without any String building
+        //
+        typedef struct
+        {
+            DEVICE* device;
+            const char* target;   // Lowercase device/service type
+            const char* nt;       // Device/service type (as advertised)
+            const char* udn;      // Shared with the owning device entry
+            const char* location; // ...
+            const char* server;   // ...
+            uint16_t baseLen;     // Length of target, less any version field
+            uint16_t version;     // Version field (0 = none)
+            bool isDevice;
+            bool isRoot;
+        } ssdp_target_t;
+
+        ssdp_target_t* _ssdpTargets;
+        int _ssdpTargetCount;
+
+        // Recent searches (LRU), a repeat of the same search from the same
+        // control point within its MX window is not answered again
+        //
+        typedef struct
+        {
+            uint32_t addr;
+            uint16_t port;
+            uint32_t hash; // Search target (case insensitive)
+            uint32_t expires;
+            uint32_t used;
+        } ssdp_search_t;
+
+        // Per control point token bucket, capping search reply bandwidth
+        //
+        typedef struct
+        {
+            uint32_t addr;
+            uint32_t refill;
+            uint32_t used;
+            uint16_t tokens;
+        } ssdp_source_t;
+
+        ssdp_search_t _ssdpSearches[EZ_SSDP_SEARCH_CACHE];
+        ssdp_source_t _ssdpSources[EZ_SSDP_REPLY_SOURCES];
+        ssdp_stats_t _ssdpStats;
+
         SemaphoreHandle_t _mutexLock;
         EventGroupHandle_t _eventGroup;
         const int CONNECTED_BIT = BIT0;
@@ -122,6 +190,7 @@ namespace EZ
         const int MDNS_BIT = BIT3;
         const int SSDP_BIT = BIT4;
         const int OTAU_BIT = BIT5;
+        const int NVS_BIT = BIT6;
         const int EZIOT_BIT = BIT8;
 
 #if defined(ARDUINO_ARCH_ESP32)
@@ -150,6 +219,7 @@ namespace EZ
 
         void _mdnsStart(void);
         void _mdnsStop(void);
+        int _mdnsDevices(DEVICE* device, int index);
 
         void _otauStart(void);
         void _otauStop(void);
@@ -159,6 +229,11 @@ namespace EZ
         int _otauParseInt(AsyncUDPPacket& packet);
         String _otauReadStringUntil(AsyncUDPPacket& packet, char end);
 
+        static void _nvsTask(void*);
+        void _nvsStart(void);
+        void _nvsStop(void);
+        void _nvsFlush(DEVICE* device, bool force, uint32_t* writes = nullptr, uint32_t* avoided = nullptr);
+
         static void _eventTask(void*);
         void _eventStart(void);
         void _eventStop(void);
@@ -170,11 +245,21 @@ namespace EZ
         void _ssdpNotify(DEVICE* dev, ssdp_method_t method, AsyncUDPPacket* packet = nullptr);
         void _ssdpNotify(UPNP::SCP* service, ssdp_method_t method, AsyncUDPPacket* packet = nullptr);
         void _ssdpRespond(const char* loc, const char* usn, const char* stnt, const char* dx, const char* mv,
-                          ssdp_method_t method, AsyncUDPPacket* packet = nullptr);
+                          bool ids, ssdp_method_t method, AsyncUDPPacket* packet = nullptr);
         void _ssdpRequest(AsyncUDPPacket packet);
-        void _ssdpRoot(AsyncUDPPacket& packet);
-        void _ssdpAll(DEVICE* device, AsyncUDPPacket& packet);
-        void _ssdpMatch(DEVICE* device, String& st, AsyncUDPPacket& packet);
+        void _ssdpSearch(const char* st, AsyncUDPPacket& packet);
+        bool _ssdpDuplicate(const char* st, int mx, AsyncUDPPacket& packet);
+        ssdp_source_t* _ssdpSource(AsyncUDPPacket& packet);
+        void _ssdpReply(ssdp_target_t* target, const char* st, const char* nt, ssdp_source_t* source,
+                        AsyncUDPPacket& packet);
+        void _ssdpIndex(void);
+        int _ssdpIndexAdd(DEVICE* device, int index);
+        void _ssdpIndexFree(void);
+        void _ssdpBootCount(void);
+        uint32_t _ssdpConfigHash(DEVICE* device, uint32_t hash, bool root);
+        uint32_t _ssdpConfigVersion(DEVICE* device);
+        bool _ssdpConfigUpdate(bool reindex = false);
+        void _ssdpConfigSet(DEVICE* device);
         int _ssdpParse(String* token, bool break_on_space, bool break_on_colon, AsyncUDPPacket& packet);
     };
 
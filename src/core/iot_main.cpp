@@ -38,10 +38,15 @@ IOT::IOT()
       _wifiPASS("wifiPASS", false, true, "", EZ_MAX_PASS), _timeZone("tz", false, true, EZ_DEFAULT_TIMEZONE, 32),
       _timeSvr1("tzs1", false, true, EZ_DEFAULT_TIMESERVER, EZ_MAX_HOST),
       _otauPASS("otauPASS", false, true, "", EZ_MAX_PASS), _otauPort("otauPort", false, true, EZ_OTAU_PORT),
-      _headDevice(nullptr), _tailDevice(nullptr), _systemStart(false), _needRestart(false)
+      _headDevice(nullptr), _tailDevice(nullptr), _systemStart(false), _needRestart(false), _dnssdDevices(false),
+      _dnssdPublished(false), _nvsDebounce(EZ_NVS_DEBOUNCE), _nvsMaxLatency(EZ_NVS_MAX_LATENCY), _ssdpBootId(0),
+      _ssdpConfigId(0), _ssdpConfigSeen(0), _ssdpTargets(nullptr), _ssdpTargetCount(0)
 {
     _mutexLock = xSemaphoreCreateMutex();
     _eventGroup = xEventGroupCreate();
+    memset(_ssdpSearches, 0, sizeof(_ssdpSearches));
+    memset(_ssdpSources, 0, sizeof(_ssdpSources));
+    memset(&_ssdpStats, 0, sizeof(_ssdpStats));
     _headDevice = _tailDevice = &root;
 }
 
@@ -112,14 +117,20 @@ void IOT::start(uint16_t webPort)
 
     ESP_ERROR_CHECK(ret);
 
+    _ssdpBootCount();
     _eventStart();
 
     root._httpPort = webPort;
     _nodeCount = 0;
     _control(_headDevice, CONTROL::INIT);
 
+    // UPnP 1.1 CONFIGID.UPNP.ORG, from the descriptions as configured
+    _ssdpConfigUpdate();
+
     ESP_LOGV(iotTag, "Node Count: %d", _nodeCount);
 
+    _nvsStart();
+
     if (_wifiStart() != WL_CONNECTED)
     {
         // Start captive config portal??
@@ -198,6 +209,7 @@ void IOT::stop(void)
     _systemStart = false;
     console.printf(LOG::INFO1, "** System Shutdown **");
     xEventGroupClearBits(_eventGroup, EZIOT_BIT);
+    _nvsStop();
     _control(_headDevice, CONTROL::STOP);
     _eventStop();
     _wifiStop();
@@ -353,9 +365,17 @@ void IOT::_control(DEVICE* device, iot_control_t mode)
                         if ((err = nvs_open(tag, NVS_READWRITE, &service->_nvsHandle)))
                         {
                             service->_nvsHandle = 0;
-                            ESP_LOGE(_tag, "NVS: Open failed: %s", nvs_error(err));
+                            ESP_LOGE(iotTag, "NVS: Open failed: %s", nvs_error(err));
                         }
-                        
+                        else
+                        {
+                            uint32_t start = micros();
+                            uint16_t loaded = service->_nvsPreload(tag);
+
+                            console.printf(LOG::INFO2, "NVS: %s (%s) preloaded %u in %u us", tag, service->_name,
+                                           loaded, micros() - start);
+                        }
+
                         if (service->_onActivityCb)
                             (void)service->_onActivityCb(nullptr, SERVICE::CALLBACK::INIT, service);
 
@@ -79,6 +79,14 @@ void IOT::_mdnsStart(void)
         {
             console.printf(LOG::INFO1, "mDNS: Started.");
             // mdnsInstance(iotTag);
+
+            if (_dnssdDevices)
+            {
+                int published = _mdnsDevices(_headDevice, 0);
+
+                _dnssdPublished = (published > 0);
+                console.printf(LOG::INFO1, "mDNS: Published %d device(s)", published);
+            }
         }
         else
             console.printf(LOG::WARNING, "mDNS: failed to set hostname");
@@ -92,7 +100,63 @@ void IOT::_mdnsStop(void)
     if (xEventGroupGetBits(_eventGroup) & MDNS_BIT)
     {
         xEventGroupClearBits(_eventGroup, MDNS_BIT);
+        _dnssdPublished = false;
         mdns_free();
         console.printf(LOG::INFO1, "mDNS: Stopped.");
     }
 }
+
+/*
+** DNS-SD Devices
+**
+** Publishes every root and embedded device under the one service type EZ_DNSSD_SERVICE._tcp,
+** giving control points a low chatter alternative to SSDP multicast. Each device is an
+** instance named by its friendly name and the tail of its UDN (friendly names needn't be
+** unique, instance names must), with TXT records carrying the UPnP device type, UDN and
+** LOCATION.
+**
+** Before IDF 5 the responder holds a single instance per service type, there the first
+** device is the instance and the others are listed in its TXT record by LOCATION (location1,
+** location2 ...), their descriptions give the rest. Returns the number of devices published.
+*/
+int IOT::_mdnsDevices(DEVICE* device, int index)
+{
+    for (; device; device = device->nextDevice())
+    {
+        if (device->ssdpAlive())
+        {
+            String nt = device->upnpDeviceType();
+            String udn = device->upnpUDN();
+            String loc = device->urlSchema(false);
+            String fn = device->upnpFriendlyName();
+            String instance = fn.substring(0, 63 - 11) + " (" +
+                              udn.substring(udn.length() > 13 ? udn.length() - 8 : 5) + ")";
+            mdns_txt_item_t txtData[3] = {{(char*)"type", (char*)nt.c_str()},
+                                          {(char*)"udn", (char*)udn.c_str()},
+                                          {(char*)"location", (char*)loc.c_str()}};
+            esp_err_t err;
+
+#if defined(ESP_IDF_VERSION_MAJOR) && ESP_IDF_VERSION_MAJOR >= 5
+            err = mdns_service_add_for_host(instance.c_str(), EZ_DNSSD_SERVICE, "_tcp", NULL, device->httpPort(), txtData, 3);
+#else
+            if (!index)
+                err = mdns_service_add(instance.c_str(), EZ_DNSSD_SERVICE, "_tcp", device->httpPort(), txtData, 3);
+            else
+            {
+                char key[16];
+
+                sprintf(key, "location%d", index);
+                err = mdns_service_txt_item_set(EZ_DNSSD_SERVICE, "_tcp", key, loc.c_str());
+            }
+#endif
+            if (err == ESP_OK)
+                index++;
+            else
+                console.printf(LOG::WARNING, "mDNS: failed to publish %s (%d)", instance.c_str(), err);
+        }
+
+        index = _mdnsDevices(device->headDevice(), index);
+    }
+
+    return index;
+}
@@ -0,0 +1,97 @@
+/*
+** EZIoT - IOT Controller: NVS Persister
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "ez_service.h"
+#include "iot.h"
+
+using namespace EZ;
+
+void IOT::nvsPersist(uint32_t debounce, uint32_t maxLatency)
+{
+    _nvsDebounce = debounce;
+    _nvsMaxLatency = max(maxLatency, debounce);
+}
+
+/*
+** NVS Persister Task
+**
+** Changes to NVS backed variables are marked dirty in their service, a service is written
+** out (one commit for all its dirty variables) once it has been quiet for _nvsDebounce ms,
+** or its oldest change is _nvsMaxLatency ms old, so a run of rapid changes costs a single
+** flash write.
+*/
+static volatile TaskHandle_t _nvs_handle = NULL;
+
+void IOT::_nvsTask(void* pv)
+{
+    while (xEventGroupGetBits(iot._eventGroup) & iot.NVS_BIT)
+    {
+        vTaskDelay(EZ_NVS_FLUSH_TICK / portTICK_PERIOD_MS);
+        iot._nvsFlush(iot._headDevice, false);
+    }
+
+    iot.console.printf(LOG::INFO1, "NVS: Persister Stopped.");
+    _nvs_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+void IOT::_nvsStart(void)
+{
+    if (!_nvs_handle)
+    {
+        xEventGroupSetBits(_eventGroup, NVS_BIT);
+        xTaskCreate(_nvsTask, "iotNVS", 4096, NULL, tskIDLE_PRIORITY + 1, (TaskHandle_t*)&_nvs_handle);
+
+        if (!_nvs_handle)
+        {
+            // Changes will still be written on stop/restart
+            xEventGroupClearBits(_eventGroup, NVS_BIT);
+            console.printf(LOG::ERROR, "NVS: failed to create persister task.");
+        }
+    }
+}
+
+void IOT::_nvsStop(void)
+{
+    uint32_t writes = 0;
+    uint32_t avoided = 0;
+
+    xEventGroupClearBits(_eventGroup, NVS_BIT);
+
+    while (_nvs_handle)
+    {
+        vTaskDelay(10);
+    }
+
+    // Synchronous flush of anything outstanding
+    _nvsFlush(_headDevice, true, &writes, &avoided);
+    console.printf(LOG::INFO1, "NVS: %u writes, %u avoided", writes, avoided);
+}
+
+void IOT::_nvsFlush(DEVICE* device, bool force, uint32_t* writes, uint32_t* avoided)
+{
+    for (; device; device = device->nextDevice())
+    {
+        for (SERVICE* service = device->headService(); service; service = service->nextService())
+        {
+            service->_nvsFlush(force, _nvsDebounce, _nvsMaxLatency);
+
+            if (writes)
+                *writes += service->_nvsWrites;
+            if (avoided)
+                *avoided += service->_nvsAvoided;
+        }
+
+        _nvsFlush(device->headDevice(), force, writes, avoided);
+    }
+}
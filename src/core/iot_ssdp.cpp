@@ -58,12 +58,17 @@ static const char _ssdp_packet_template[] = "CACHE-CONTROL: max-age=%u\r\n"
                                             "LOCATION: %s\r\n"
                                             "SERVER: %s\r\n"
                                             "USN: %s\r\n"
+                                            "%s" // UPnP 1.1 _ssdp_ids_template
                                             //"OPT: \"http://schemas.upnp.org/upnp/1/0/\"; ns=01\r\n"
                                             //"01-NLS: b9200ebb-736d-4b93-bf03-835149d13983\r\n"
                                             //"X-User-Agent: redsonic\r\n"
                                             "%s" // Device specific headers ssdpExtra()!
                                             "\r\n";
 
+// Only from devices that claim UPnP 1.1 or later, as their descriptions carry the configId
+static const char _ssdp_ids_template[] = "BOOTID.UPNP.ORG: %u\r\n"
+                                         "CONFIGID.UPNP.ORG: %u\r\n";
+
 /*
 ** SSDP Advertiser Task
 */
@@ -88,16 +93,24 @@ void IOT::_ssdpTask(void* pv)
     int bootCount = 3 - 1;
     EventBits_t bits;
 
-    iot._ssdpAdvertAge = EZ_SSDP_ADVERT_AGE; // CACHE-CONTROL max-age
+    iot._ssdpAdvertAge = EZ_SSDP_ADVERT_AGE;
 
     while ((bits = xEventGroupGetBits(iot._eventGroup)) & iot.SSDP_BIT)
     {
         vTaskDelay(portTICK_PERIOD_MS);
 
+        // A changed description (friendly name, UDN) is searched for and advertised at once
+        if (iot._ssdpConfigUpdate(true))
+            nextAdvert.timerTrigger();
+
         if (nextAdvert.timerExpired())
         {
             if (bits & iot.CONNECTED_BIT)
             {
+                // CACHE-CONTROL max-age, while the devices are also published by DNS-SD they can
+                // re-advertise less often (mDNS starts and stops with the connection)
+                iot._ssdpAdvertAge = iot._dnssdPublished ? EZ_SSDP_DNSSD_ADVERT_AGE : EZ_SSDP_ADVERT_AGE;
+
                 // On bootup, we send adverts x (3) times ~200-500ms apart
                 if (bootCount)
                 {
@@ -161,6 +174,10 @@ void IOT::_ssdpStart(void)
 {
     if (!_ssdp_handle)
     {
+        EZ_IOT_MUTEX_TAKE();
+        _ssdpIndex();
+        EZ_IOT_MUTEX_GIVE();
+
         xEventGroupSetBits(_eventGroup, SSDP_BIT);
         xTaskCreate(_ssdpTask, "iotSSDP", 4096, NULL, tskIDLE_PRIORITY, (TaskHandle_t*)&_ssdp_handle);
 
@@ -193,6 +210,10 @@ void IOT::_ssdpStop(void)
             vTaskDelay(10);
         }
     }
+
+    EZ_IOT_MUTEX_TAKE();
+    _ssdpIndexFree();
+    EZ_IOT_MUTEX_GIVE();
 }
 
 void IOT::_ssdpNotify(DEVICE* device, ssdp_method_t method, AsyncUDPPacket* packet)
@@ -207,18 +228,18 @@ void IOT::_ssdpNotify(DEVICE* device, ssdp_method_t method, AsyncUDPPacket* pack
             String usn = uu + "::" + nt;
 
             _ssdpRespond(device->urlSchema(false).c_str(), usn.c_str(), nt.c_str(), device->ssdpExtra().c_str(),
-                         device->upnpServer().c_str(), method, packet);
+                         device->upnpServer().c_str(), device->upnpBootIds(), method, packet);
             vTaskDelay(50 / portTICK_PERIOD_MS);
         }
 
         _ssdpRespond(device->urlSchema(false).c_str(), uu.c_str(), uu.c_str(), device->ssdpExtra().c_str(),
-                     device->upnpServer().c_str(), method, packet);
+                     device->upnpServer().c_str(), device->upnpBootIds(), method, packet);
         vTaskDelay(50 / portTICK_PERIOD_MS);
 
         String nt = device->upnpDeviceType();
         String usn = uu + "::" + nt;
         _ssdpRespond(device->urlSchema(false).c_str(), usn.c_str(), nt.c_str(), device->ssdpExtra().c_str(),
-                     device->upnpServer().c_str(), method, packet);
+                     device->upnpServer().c_str(), device->upnpBootIds(), method, packet);
         vTaskDelay(50 / portTICK_PERIOD_MS);
     }
 }
@@ -235,16 +256,17 @@ void IOT::_ssdpNotify(UPNP::SCP* service, ssdp_method_t method, AsyncUDPPacket*
             String usn = device->upnpUDN() + "::" + nt;
 
             _ssdpRespond(device->urlSchema(false).c_str(), usn.c_str(), nt.c_str(), device->ssdpExtra().c_str(),
-                         device->upnpServer().c_str(), method, packet);
+                         device->upnpServer().c_str(), device->upnpBootIds(), method, packet);
             vTaskDelay(100 / portTICK_PERIOD_MS);
         }
     }
 }
 
 void IOT::_ssdpRespond(const char* loc, const char* usn, const char* stnt, const char* dx, const char* mv,
-                       ssdp_method_t method, AsyncUDPPacket* packet)
+                       bool ids, ssdp_method_t method, AsyncUDPPacket* packet)
 {
     char buffer[512];
+    char idx[64] = "";
     int len;
 
     if (!dx)
@@ -269,7 +291,10 @@ void IOT::_ssdpRespond(const char* loc, const char* usn, const char* stnt, const
         len = snprintf(buffer, sizeof(buffer), _ssdp_respond_template, dateRFC1123(&info).c_str(), stnt);
     }
 
-    snprintf(&buffer[len], sizeof(buffer) - len, _ssdp_packet_template, _ssdpAdvertAge, loc, mv, usn, dx);
+    if (ids)
+        snprintf(idx, sizeof(idx), _ssdp_ids_template, _ssdpBootId, _ssdpConfigId);
+
+    snprintf(&buffer[len], sizeof(buffer) - len, _ssdp_packet_template, _ssdpAdvertAge, loc, mv, usn, idx, dx);
 
     if (method != SSDP::NONE && !packet)
     {
@@ -400,6 +425,16 @@ void IOT::_ssdpRequest(AsyncUDPPacket packet)
     {
         uint32_t _delay = random(1, _mx) * 1000L;
 
+        _ssdpStats.searches++;
+
+        if (_ssdpDuplicate(_st.c_str(), _mx, packet))
+        {
+            console.printf(LOG::INFO2, "SSDP: Duplicate (%s:%u) - %s, Ignored", packet.remoteIP().toString().c_str(),
+                           packet.remotePort(), _st.c_str());
+            packet.flush();
+            return;
+        }
+
         vTaskDelay(_delay / portTICK_PERIOD_MS);
 
         if (!EZ_IOT_MUTEX_TAKE())
@@ -416,18 +451,7 @@ void IOT::_ssdpRequest(AsyncUDPPacket packet)
            _delay);
         */
 
-        if (_st.equalsIgnoreCase("upnp:rootdevice"))
-        {
-            _ssdpRoot(packet);
-        }
-        else if (_st.equalsIgnoreCase("ssdp:all"))
-        {
-            _ssdpAll(_headDevice, packet);
-        }
-        else
-        {
-            _ssdpMatch(_headDevice, _st, packet);
-        }
+        _ssdpSearch(_st.c_str(), packet);
 
         EZ_IOT_MUTEX_GIVE();
         return;
@@ -439,84 +463,462 @@ bailOut:
     packet.flush();
 }
 
-void IOT::_ssdpRoot(AsyncUDPPacket& packet)
+/*
+** SSDP Search
+**
+** Matches the search target against the index built by _ssdpIndex(), replying once for
+** every device/service it satisfies. Typed searches (urn:) follow UPnP version semantics,
+** a device or service of version N answers any search for versions 1 to N. A search with
+** no version field (or the Wemo "**" wildcard) is treated as a prefix match.
+*/
+static uint16_t _ssdpVersion(const char* target, size_t len, uint16_t* baseLen)
 {
-    DEVICE* device = _headDevice;
+    const char* colon = strrchr(target, ':');
 
-    if (!device)
-        return;
-    do
+    if (colon && (colon - target) < (int)len && isdigit(colon[1]))
+    {
+        *baseLen = colon - target + 1;
+        return atoi(colon + 1);
+    }
+
+    *baseLen = len;
+    return 0;
+}
+
+void IOT::_ssdpSearch(const char* st, AsyncUDPPacket& packet)
+{
+    typedef enum
+    {
+        ALL,
+        ROOT,
+        UUID,
+        URN
+    } search_t;
+
+    size_t len = strlen(st);
+    uint16_t baseLen = len;
+    uint16_t version = 0;
+    search_t search = URN;
+    ssdp_source_t* source = _ssdpSource(packet);
+
+    if (strcasecmp(st, "ssdp:all") == 0)
+        search = ALL;
+    else if (strcasecmp(st, "upnp:rootdevice") == 0)
+        search = ROOT;
+    else if (strncasecmp(st, "uuid:", 5) == 0)
+        search = UUID;
+    else if (len > 2 && strcmp(&st[len - 2], "**") == 0)
+        baseLen = len - 2; // Fudge for Wemo's (urn:Belkin:device:**)
+    else
+        version = _ssdpVersion(st, len, &baseLen);
+
+    for (int i = 0; i < _ssdpTargetCount; i++)
     {
-        if (!device->_homeDevice && device->_iotCode && device->ssdpAlive())
+        ssdp_target_t* target = &_ssdpTargets[i];
+
+        if (!target->device->ssdpAlive())
+            continue;
+
+        switch (search)
         {
-            String usn = device->upnpUDN() + "::" + device->upnpDeviceType();
-            _ssdpRespond(device->urlSchema(false).c_str(), usn.c_str(), "upnp:rootdevice", device->ssdpExtra().c_str(),
-                         device->upnpServer().c_str(), SSDP::NONE, &packet);
+            case ALL:
+                if (target->isRoot)
+                    _ssdpReply(target, "upnp:rootdevice", "upnp:rootdevice", source, packet);
+                if (target->isDevice)
+                    _ssdpReply(target, target->udn, nullptr, source, packet);
+                _ssdpReply(target, target->nt, target->nt, source, packet);
+                vTaskDelay(10 / portTICK_PERIOD_MS);
+                break;
+
+            case ROOT:
+                if (target->isRoot)
+                    _ssdpReply(target, st, "upnp:rootdevice", source, packet);
+                break;
+
+            case UUID:
+                if (target->isDevice && strcasecmp(st, target->udn) == 0)
+                    _ssdpReply(target, st, nullptr, source, packet);
+                break;
+
+            case URN:
+                if (version)
+                {
+                    if (target->baseLen != baseLen || target->version < version)
+                        break;
+                }
+                if (strncasecmp(target->target, st, baseLen) == 0)
+                    _ssdpReply(target, st, target->nt, source, packet);
+                break;
         }
-    } while ((device = device->_nextDevice));
+    }
 }
 
-void IOT::_ssdpAll(DEVICE* device, AsyncUDPPacket& packet)
+void IOT::_ssdpReply(ssdp_target_t* target, const char* st, const char* nt, ssdp_source_t* source,
+                     AsyncUDPPacket& packet)
 {
-    if (!device)
-        return;
-    do
+    if (source)
     {
-        if (device->ssdpAlive())
+        if (!source->tokens)
         {
-            SERVICE* service;
+            _ssdpStats.throttled++;
+            return;
+        }
+        source->tokens--;
+    }
 
-            _ssdpNotify(device, SSDP::NONE, &packet);
+    // USN is the device UDN, qualified by the notification type when given
+    char usn[strlen(target->udn) + (nt ? strlen(nt) + 2 : 0) + 1];
 
-            if ((service = device->_headService))
-            {
-                do
-                {
-                    if (service->mode() == SERVICE::MODE::UPNP)
-                        _ssdpNotify(reinterpret_cast<UPNP::SCP*>(service), SSDP::NONE, &packet);
-                } while ((service = service->_nextService));
-            }
+    if (nt)
+        sprintf(usn, "%s::%s", target->udn, nt);
+    else
+        strcpy(usn, target->udn);
+
+    _ssdpRespond(target->location, usn, st, target->device->ssdpExtra().c_str(), target->server,
+                 target->device->upnpBootIds(), SSDP::NONE, &packet);
+    _ssdpStats.replies++;
+}
+
+/*
+** SSDP Search Suppression
+**
+** Control points often repeat an M-SEARCH several times within its MX window, only the
+** first copy is answered. Replies to each control point are also metered through a token
+** bucket (EZ_SSDP_REPLY_BURST, refilled at EZ_SSDP_REPLY_RATE per second). Both tables are
+** only touched from the AsyncUDP packet callback, so need no locking.
+*/
+static uint32_t _ssdpHash(const char* str, uint32_t hash = 2166136261UL, bool fold = true)
+{
+    // FNV-1a
+    while (*str)
+        hash = (hash ^ (uint8_t)(fold ? tolower(*str++) : *str++)) * 16777619UL;
+    return hash;
+}
+
+bool IOT::_ssdpDuplicate(const char* st, int mx, AsyncUDPPacket& packet)
+{
+    uint32_t addr = (uint32_t)packet.remoteIP();
+    uint16_t port = packet.remotePort();
+    uint32_t hash = _ssdpHash(st);
+    uint32_t now = millis();
+    ssdp_search_t* search = &_ssdpSearches[0];
+
+    for (int i = 0; i < EZ_SSDP_SEARCH_CACHE; i++)
+    {
+        ssdp_search_t* entry = &_ssdpSearches[i];
+        bool expired = (int32_t)(now - entry->expires) >= 0;
+
+        if (!expired && entry->addr == addr && entry->port == port && entry->hash == hash)
+        {
+            entry->used = now;
+            _ssdpStats.duplicates++;
+            return true;
         }
-    } while ((device = device->_nextDevice));
+
+        // Reuse an expired entry, else the least recently used
+        if (expired)
+            search = entry;
+        else if ((int32_t)(search->expires - now) > 0 && (int32_t)(entry->used - search->used) < 0)
+            search = entry;
+    }
+
+    search->addr = addr;
+    search->port = port;
+    search->hash = hash;
+    search->expires = now + (max(mx, 1) * 1000L) + 500;
+    search->used = now;
+    return false;
 }
 
-void IOT::_ssdpMatch(DEVICE* device, String& st, AsyncUDPPacket& packet)
+IOT::ssdp_source_t* IOT::_ssdpSource(AsyncUDPPacket& packet)
 {
-    if (!device)
-        return;
-    do
+    uint32_t addr = (uint32_t)packet.remoteIP();
+    uint32_t now = millis();
+    ssdp_source_t* source = &_ssdpSources[0];
+
+    for (int i = 0; i < EZ_SSDP_REPLY_SOURCES; i++)
     {
-        SERVICE* service;
+        if (_ssdpSources[i].addr == addr)
+        {
+            source = &_ssdpSources[i];
+            break;
+        }
+
+        if ((int32_t)(_ssdpSources[i].used - source->used) < 0)
+            source = &_ssdpSources[i];
+    }
+
+    if (source->addr != addr)
+    {
+        source->addr = addr;
+        source->tokens = EZ_SSDP_REPLY_BURST;
+        source->refill = now;
+    }
+    else
+    {
+        uint32_t elapsed = now - source->refill;
+        uint32_t tokens;
 
-        if (device->ssdpAlive())
+        // Long idle sources just refill, and the multiply can't overflow
+        if (elapsed > (EZ_SSDP_REPLY_BURST * 1000L) / EZ_SSDP_REPLY_RATE)
+            elapsed = (EZ_SSDP_REPLY_BURST * 1000L) / EZ_SSDP_REPLY_RATE;
+
+        tokens = (elapsed * EZ_SSDP_REPLY_RATE) / 1000L;
+
+        if (source->tokens + tokens >= EZ_SSDP_REPLY_BURST)
         {
-            if (device->ssdpMatch(st))
-            {
-                String usn = device->upnpUDN() + "::" + device->upnpDeviceType();
-                _ssdpRespond(device->urlSchema(false).c_str(), usn.c_str(), st.c_str(), device->ssdpExtra().c_str(),
-                             device->upnpServer().c_str(), SSDP::NONE, &packet);
-            }
+            source->tokens = EZ_SSDP_REPLY_BURST;
+            source->refill = now;
+        }
+        else if (tokens)
+        {
+            source->tokens += tokens;
+            source->refill += (tokens * 1000L) / EZ_SSDP_REPLY_RATE;
+        }
+    }
+
+    source->used = now;
+    return source;
+}
 
-            if ((service = device->_headService))
+/*
+** SSDP Search Index
+**
+** One entry per device and UPnP service (embedded devices included), each holding a
+** lowercase copy of its type along with the UDN, LOCATION and SERVER strings needed to
+** reply. Services share the strings of their device entry. Rebuilt on each _ssdpStart()
+** as LOCATION changes with the station IP address.
+*/
+static char* _ssdpCopy(char* dst, const char* src, bool lower = false)
+{
+    while ((*dst++ = (lower ? tolower(*src) : *src)))
+        src++;
+    return dst;
+}
+
+static int _ssdpIndexCount(DEVICE* device)
+{
+    int count = 0;
+
+    for (; device; device = device->nextDevice())
+    {
+        count++;
+
+        for (SERVICE* service = device->headService(); service; service = service->nextService())
+        {
+            if (service->mode() == SERVICE::MODE::UPNP)
+                count++;
+        }
+
+        count += _ssdpIndexCount(device->headDevice());
+    }
+
+    return count;
+}
+
+void IOT::_ssdpIndex(void)
+{
+    int count;
+
+    _ssdpIndexFree();
+
+    if (!(count = _ssdpIndexCount(_headDevice)))
+        return;
+
+    if (!(_ssdpTargets = (ssdp_target_t*)calloc(count, sizeof(ssdp_target_t))))
+    {
+        console.printf(LOG::ERROR, "SSDP: No memory for search index!");
+        return;
+    }
+
+    _ssdpTargetCount = _ssdpIndexAdd(_headDevice, 0);
+    console.printf(LOG::INFO2, "SSDP: Indexed %d search targets", _ssdpTargetCount);
+}
+
+int IOT::_ssdpIndexAdd(DEVICE* device, int index)
+{
+    for (; device; device = device->nextDevice())
+    {
+        ssdp_target_t* home = &_ssdpTargets[index];
+        String nt = device->upnpDeviceType();
+        String udn = device->upnpUDN();
+        String loc = device->urlSchema(false);
+        String mv = device->upnpServer();
+        char* str;
+
+        // A device we can't index (nor its services, which share its strings) is skipped,
+        // its embedded devices are still indexed below
+        if (!(str = (char*)malloc((nt.length() + 1) * 2 + udn.length() + loc.length() + mv.length() + 3)))
+            console.printf(LOG::ERROR, "SSDP: No memory to index %s", udn.c_str());
+        else
+        {
+            home->device = device;
+            home->isDevice = true;
+            home->isRoot = (!device->_homeDevice && device->_iotCode);
+            home->target = str;
+            str = _ssdpCopy(str, nt.c_str(), true);
+            home->nt = str;
+            str = _ssdpCopy(str, nt.c_str());
+            home->udn = str;
+            str = _ssdpCopy(str, udn.c_str());
+            home->location = str;
+            str = _ssdpCopy(str, loc.c_str());
+            home->server = str;
+            _ssdpCopy(str, mv.c_str());
+            home->version = _ssdpVersion(home->target, nt.length(), &home->baseLen);
+            index++;
+
+            for (SERVICE* service = device->headService(); service; service = service->nextService())
             {
-                do
+                if (service->mode() == SERVICE::MODE::UPNP)
                 {
-                    if (service->mode() == SERVICE::MODE::UPNP)
-                    {
-                        UPNP::SCP* upnp = reinterpret_cast<UPNP::SCP*>(service);
-
-                        if (upnp->upnpServiceType() == st)
-                        {
-                            String usn = device->upnpUDN() + "::" + upnp->upnpServiceType();
-                            _ssdpRespond(device->urlSchema(false).c_str(), usn.c_str(), st.c_str(),
-                                         device->ssdpExtra().c_str(), device->upnpServer().c_str(), SSDP::NONE,
-                                         &packet);
-                        }
-                    }
-                } while ((service = service->_nextService));
+                    ssdp_target_t* target = &_ssdpTargets[index];
+                    String st = reinterpret_cast<UPNP::SCP*>(service)->upnpServiceType();
+
+                    if (!(str = (char*)malloc((st.length() + 1) * 2)))
+                        continue;
+
+                    target->device = device;
+                    target->target = str;
+                    str = _ssdpCopy(str, st.c_str(), true);
+                    target->nt = str;
+                    _ssdpCopy(str, st.c_str());
+                    target->udn = home->udn;
+                    target->location = home->location;
+                    target->server = home->server;
+                    target->version = _ssdpVersion(target->target, st.length(), &target->baseLen);
+                    index++;
+                }
             }
         }
-    } while ((device = device->_nextDevice));
+
+        index = _ssdpIndexAdd(device->headDevice(), index);
+    }
+
+    return index;
+}
+
+void IOT::_ssdpIndexFree(void)
+{
+    if (_ssdpTargets)
+    {
+        // Each entry owns a single string block, starting at target
+        for (int i = 0; i < _ssdpTargetCount; i++)
+            free((void*)_ssdpTargets[i].target);
+
+        free(_ssdpTargets);
+        _ssdpTargets = nullptr;
+    }
+
+    _ssdpTargetCount = 0;
+}
+
+/*
+** SSDP BOOTID/CONFIGID
+**
+** BOOTID.UPNP.ORG is kept in NVS and advanced on every boot, so control points can detect
+** that we have rebooted (and may have lost subscriptions). CONFIGID.UPNP.ORG is a hash of
+** the device and service descriptions we serve, so control points can keep using their
+** cached copies until it changes. It's recomputed whenever a device's configuration does,
+** and the new value advertised straight away.
+*/
+void IOT::_ssdpBootCount(void)
+{
+    nvs_handle handle;
+    esp_err_t err;
+
+    if ((err = nvs_open("eziot", NVS_READWRITE, &handle)) == ESP_OK)
+    {
+        uint32_t bootId = 0;
+
+        nvs_get_u32(handle, "bootId", &bootId);
+        _ssdpBootId = (bootId + 1) & 0x7FFFFFFF;
+
+        if ((err = nvs_set_u32(handle, "bootId", _ssdpBootId)) == ESP_OK)
+            err = nvs_commit(handle);
+        nvs_close(handle);
+    }
+
+    if (err != ESP_OK)
+        ESP_LOGE(iotTag, "NVS: BootId failed: %s", nvs_error(err));
+}
+
+// The descriptions as served, a root device's (which holds its embedded devices) and every
+// service's SCPD. The root's configId attribute is left out, it's what we're computing.
+uint32_t IOT::_ssdpConfigHash(DEVICE* device, uint32_t hash, bool root)
+{
+    for (; device; device = device->nextDevice())
+    {
+        if (root)
+            hash = _ssdpHash(device->upnpXML(false).c_str(), hash, false);
+
+        for (SERVICE* service = device->headService(); service; service = service->nextService())
+        {
+            if (service->mode() == SERVICE::MODE::UPNP)
+                hash = _ssdpHash(reinterpret_cast<UPNP::SCP*>(service)->upnpXML().c_str(), hash, false);
+        }
+
+        hash = _ssdpConfigHash(device->headDevice(), hash, false);
+    }
+
+    return hash;
+}
+
+// Descriptions only change with a device's configuration (friendly name, UUID ...)
+uint32_t IOT::_ssdpConfigVersion(DEVICE* device)
+{
+    uint32_t version = 0;
+
+    for (; device; device = device->nextDevice())
+        version += device->_config.version() + _ssdpConfigVersion(device->headDevice());
+
+    return version;
+}
+
+// Recomputes CONFIGID.UPNP.ORG (24 bits) once the configuration has moved on, returns true
+// when it has changed (having rebuilt the search index if asked to)
+bool IOT::_ssdpConfigUpdate(bool reindex)
+{
+    uint32_t version = _ssdpConfigVersion(_headDevice);
+    uint32_t configId;
+
+    if (_ssdpConfigId && version == _ssdpConfigSeen)
+        return false;
+
+    _ssdpConfigSeen = version;
+    configId = _ssdpConfigHash(_headDevice, 2166136261UL, true) & 0xFFFFFF;
+
+    if (configId == _ssdpConfigId)
+        return false;
+
+    _ssdpConfigId = configId;
+    _ssdpConfigSet(_headDevice);
+    console.printf(LOG::INFO1, "SSDP: BootId %u, ConfigId %u", _ssdpBootId, _ssdpConfigId);
+
+    if (reindex)
+    {
+        EZ_IOT_MUTEX_TAKE();
+        _ssdpIndex();
+        EZ_IOT_MUTEX_GIVE();
+    }
+
+    return true;
+}
+
+void IOT::_ssdpConfigSet(DEVICE* device)
+{
+    for (; device; device = device->nextDevice())
+    {
+        device->_upnpConfigId = _ssdpConfigId;
+
+        for (SERVICE* service = device->headService(); service; service = service->nextService())
+        {
+            if (service->mode() == SERVICE::MODE::UPNP)
+                reinterpret_cast<UPNP::SCP*>(service)->_upnpConfigId = _ssdpConfigId;
+        }
+
+        _ssdpConfigSet(device->headDevice());
+    }
 }
 
 // writes the next token into token if token is not NULL returns -1 on message end, otherwise returns 0
@@ -0,0 +1,135 @@
+/*
+** EZIoT - Change Tracking
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_CHANGES_H
+#define _EZ_CHANGES_H
+#include <Arduino.h>
+
+namespace EZ
+{
+    /*
+    ** Change tracking, every change bumps the version and records it against the item (its
+    ** _changedVersion, _index is its dense index here). The dirty bitmap marks which items
+    ** changed since the epoch, so a query from any version at or after the epoch only visits
+    ** the changed items. When over half are dirty the bitmap is restarted, older queries
+    ** fall back to a full scan. Not locked, the owner serialises.
+    */
+    template<class _T> class CHANGES
+    {
+    public:
+        CHANGES() : _version(0), _epoch(0), _map(nullptr), _items(nullptr), _count(0), _dirty(0) {}
+
+        ~CHANGES()
+        {
+            free(_items);
+            free(_map);
+        }
+
+        uint32_t version(void) const { return _version; }
+        uint32_t epoch(void) const { return _epoch; }
+        uint16_t count(void) const { return _count; }
+
+        bool add(_T* item)
+        {
+            if (!(_count & 7))
+            {
+                _T** items = (_T**)realloc(_items, (_count + 8) * sizeof(_T*));
+                uint32_t* map = (uint32_t*)realloc(_map, ((_count + 8 + 31) / 32) * sizeof(uint32_t));
+
+                if (items)
+                    _items = items;
+                if (map)
+                {
+                    _map = map;
+                    if (!(_count & 31))
+                        _map[_count >> 5] = 0;
+                }
+
+                if (!items || !map)
+                    return false;
+            }
+
+            item->_index = _count;
+            _items[_count++] = item;
+            return true;
+        }
+
+        void change(_T* item)
+        {
+            item->_changedVersion = ++_version;
+
+            if (item->_index < _count)
+            {
+                uint32_t bit = 1UL << (item->_index & 31);
+
+                if (!(_map[item->_index >> 5] & bit))
+                {
+                    if (++_dirty > (_count / 2) + 1)
+                    {
+                        memset(_map, 0, ((_count + 31) / 32) * sizeof(uint32_t));
+                        _epoch = _version - 1;
+                        _dirty = 1;
+                    }
+
+                    _map[item->_index >> 5] |= bit;
+                }
+            }
+        }
+
+        // Up to max of the items changed after version since, in index order
+        int since(uint32_t since, _T** list, int max) const
+        {
+            int count = 0;
+
+            if (since >= _epoch)
+            {
+                for (int w = 0; w < (_count + 31) / 32 && count < max; w++)
+                {
+                    uint32_t bits = _map[w];
+
+                    while (bits && count < max)
+                    {
+                        _T* item = _items[(w << 5) + __builtin_ctz(bits)];
+
+                        if (item->_changedVersion > since)
+                            list[count++] = item;
+                        bits &= bits - 1;
+                    }
+                }
+            }
+            else
+            {
+                for (int i = 0; i < _count && count < max; i++)
+                {
+                    if (_items[i]->_changedVersion > since)
+                        list[count++] = _items[i];
+                }
+            }
+
+            return count;
+        }
+
+    private:
+        uint32_t _version; // Bumped on every change
+        uint32_t _epoch;   // _map holds the items changed since this version
+        uint32_t* _map;
+        _T** _items; // Indexed by _T::_index
+        uint16_t _count;
+        uint16_t _dirty;
+
+        CHANGES(CHANGES const& copy);            // Not Implemented
+        CHANGES& operator=(CHANGES const& copy); // Not Implemented
+    };
+} // namespace EZ
+#endif // _EZ_CHANGES_H
+/******************************************************************************/
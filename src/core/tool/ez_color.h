@@ -18,6 +18,7 @@
 #define _EZ_COLOR_H
 #include <Arduino.h>
 #include <math.h>
+#include "ez_color_lut.h"
 
 /*
 ** Defintions and Equates
@@ -194,6 +195,32 @@ namespace EZ
             return (*this);
         }
 
+        // Convert from HSI colorspace to RGB, fixed point
+        //
+        // As fromHSIf() with hue in degrees and saturation / intensity 0..255, table driven
+        // so safe without the FPU (e.g. in an ISR). Within 1 of fromHSIf() on each channel.
+        //
+        COLOR& fromHSIi(uint16_t hue, uint8_t sat, uint8_t intensity)
+        {
+            int32_t f, p, s, t;
+
+            hue %= 360;
+            f = _hsiTable[hue % 120];
+            p = intensity * (255 * 4096 + sat * f) / (3 * 255 * 4096);
+            s = intensity * (255 * 4096 + sat * (4096 - f)) / (3 * 255 * 4096);
+            t = intensity * (255 - sat) / (3 * 255);
+
+            __sector(hue, p, s, t);
+
+            return (*this);
+        }
+
+        static void fromHSIi(COLOR* dst, const uint16_t* hue, size_t n, uint8_t sat, uint8_t intensity)
+        {
+            for (size_t i = 0; i < n; i++)
+                dst[i].fromHSIi(hue[i], sat, intensity);
+        }
+
         // Convert from HSI colorspace to RGBW
         //
         // Assumes fully saturated colors, and then scales with white to lower saturation.
@@ -249,6 +276,29 @@ namespace EZ
             return (*this);
         }
 
+        // Convert from HSI colorspace to RGBW, fixed point, see fromHSIi()
+        //
+        COLOR& fromHSIi2RGBW(uint16_t hue, uint8_t sat, uint8_t intensity)
+        {
+            int32_t f, p, s;
+
+            hue %= 360;
+            f = _hsiTable[hue % 120];
+            p = intensity * sat * (4096 + f) / (3 * 255 * 4096);
+            s = intensity * sat * (8192 - f) / (3 * 255 * 4096);
+
+            __sector(hue, p, s, 0);
+
+            w = intensity * (255 - sat) / 255;
+            return (*this);
+        }
+
+        static void fromHSIi2RGBW(COLOR* dst, const uint16_t* hue, size_t n, uint8_t sat, uint8_t intensity)
+        {
+            for (size_t i = 0; i < n; i++)
+                dst[i].fromHSIi2RGBW(hue[i], sat, intensity);
+        }
+
         // Convert from HSB colorspace to RGB(W)
         //
         COLOR& fromHSBf(float hue, float sat, float bright)
@@ -262,80 +312,44 @@ namespace EZ
             return fromHSBi(hue * 360.0, sat * 100.0, bright * 100.0);
         }
 
+        // Hue 0..360, saturation and brightness 0..100, integer math only
+        //
         COLOR& fromHSBi(int hue, int sat, int bright)
         {
+            int32_t level, p, s, t;
+
             // constrain all input variables to expected range
             hue = constrain(hue, 0, 360);
             sat = constrain(sat, 0, 100);
             bright = constrain(bright, 0, 100);
 
-            // define maximum value for RGB array elements
-            float max_rgb_val = EZ_COLOR_SATURATION;
-
-            // convert saturation and brightness value to decimals and init r, g, b variables
-            float sat_f = float(sat) / 100.0;
-            float bright_f = float(bright) / 100.0;
-
-            // If brightness is 0 then color is black (achromatic)
-            // therefore, R, G and B values will all equal to 0
-            if (bright <= 0)
-            {
-                r = g = b = w = 0;
-            }
-
             // If saturation is 0 then color is gray (achromatic)
             // therefore, R, G and B values will all equal the current brightness
             if (sat <= 0)
             {
-                r = g = b = w = bright_f * max_rgb_val;
+                r = g = b = w = bright * 255 / 100;
+                return (*this);
             }
 
-            // if saturation and brightness are greater than 0 then calculate
-            // R, G and B values based on the current hue and brightness
-            else
-            {
-                w = 0;
+            // Primary falls and secondary rises across each 120 degree sector, both lifted
+            // toward white by (100 - sat)
+            level = bright * 255;
+            t = hue < 120 ? hue : (hue < 240 ? hue - 120 : hue - 240);
+            p = level * ((120 - t) * 100 + t * (100 - sat)) / (100 * 100 * 120);
+            s = level * (t * 100 + (120 - t) * (100 - sat)) / (100 * 100 * 120);
+            t = level * (100 - sat) / (100 * 100);
 
-                if (hue >= 0 && hue < 120)
-                {
-                    float hue_primary = 1.0 - (float(hue) / 120.0);
-                    float hue_secondary = float(hue) / 120.0;
-                    float sat_primary = (1.0 - hue_primary) * (1.0 - sat_f);
-                    float sat_secondary = (1.0 - hue_secondary) * (1.0 - sat_f);
-                    float sat_tertiary = 1.0 - sat_f;
-                    r = (bright_f * max_rgb_val) * (hue_primary + sat_primary);
-                    g = (bright_f * max_rgb_val) * (hue_secondary + sat_secondary);
-                    b = (bright_f * max_rgb_val) * sat_tertiary;
-                }
-
-                else if (hue >= 120 && hue < 240)
-                {
-                    float hue_primary = 1.0 - ((float(hue) - 120.0) / 120.0);
-                    float hue_secondary = (float(hue) - 120.0) / 120.0;
-                    float sat_primary = (1.0 - hue_primary) * (1.0 - sat_f);
-                    float sat_secondary = (1.0 - hue_secondary) * (1.0 - sat_f);
-                    float sat_tertiary = 1.0 - sat_f;
-                    r = (bright_f * max_rgb_val) * sat_tertiary;
-                    g = (bright_f * max_rgb_val) * (hue_primary + sat_primary);
-                    b = (bright_f * max_rgb_val) * (hue_secondary + sat_secondary);
-                }
-
-                else if (hue >= 240 && hue <= 360)
-                {
-                    float hue_primary = 1.0 - ((float(hue) - 240.0) / 120.0);
-                    float hue_secondary = (float(hue) - 240.0) / 120.0;
-                    float sat_primary = (1.0 - hue_primary) * (1.0 - sat_f);
-                    float sat_secondary = (1.0 - hue_secondary) * (1.0 - sat_f);
-                    float sat_tertiary = 1.0 - sat_f;
-                    r = (bright_f * max_rgb_val) * (hue_secondary + sat_secondary);
-                    g = (bright_f * max_rgb_val) * sat_tertiary;
-                    b = (bright_f * max_rgb_val) * (hue_primary + sat_primary);
-                }
-            }
+            __sector(hue, p, s, t);
 
             return (*this);
         }
 
+        static void fromHSBi(COLOR* dst, const uint16_t* hue, size_t n, int sat, int bright)
+        {
+            for (size_t i = 0; i < n; i++)
+                dst[i].fromHSBi(hue[i], sat, bright);
+        }
+
         // Convert from XYB colorspace
         //
         COLOR& fromXYB(float x, float y, int bright)
@@ -422,71 +436,70 @@ namespace EZ
             return (*this);
         }
 
-        // Convert from Color Temperature
+        // Convert from XYB colorspace, fixed point
         //
-        COLOR& fromTemperature(long kelvin)
+        // As fromXYB() with x and y in 1/65536ths (0.3127 is 20493), integer math only. The
+        // linear values are Q16 and the gamma curve is interpolated from a 257 entry table.
+        //
+        COLOR& fromXYBi(uint16_t x, uint16_t y, uint8_t bright)
         {
-            long temperature = kelvin / 100;
+            int64_t X, Y, Z, fr, fg, fb, big;
 
-            w = 0;
-
-            if (temperature <= 66)
-            {
-                r = 255;
-            }
-            else
+            if (!y)
             {
-                r = temperature - 60;
-                r = 329.698727446 * pow(r, -0.1332047592);
-                if (r < 0)
-                    r = 0;
-                if (r > 255)
-                    r = 255;
+                u = 0;
+                return (*this);
             }
 
-            if (temperature <= 66)
-            {
-                g = temperature;
-                g = 99.4708025861 * log(g) - 161.1195681661;
-                if (g < 0)
-                    g = 0;
-                if (g > 255)
-                    g = 255;
-            }
-            else
-            {
-                g = temperature - 60;
-                g = 288.1221695283 * pow(g, -0.0755148492);
-                if (g < 0)
-                    g = 0;
-                if (g > 255)
-                    g = 255;
-            }
+            Y = ((int32_t)bright << 16) / 250;
+            X = Y * x / y;
+            Z = Y * (65536 - x - y) / y;
 
-            if (temperature >= 66)
-            {
-                b = 255;
-            }
-            else
+            // sRGB D65 conversion, Q14 coefficients
+            fr = (X * 53094 - Y * 25186 - Z * 8169) >> 14;
+            fg = (-X * 15875 + Y * 30733 + Z * 680) >> 14;
+            fb = (X * 913 - Y * 3342 + Z * 17318) >> 14;
+
+            // Scale the biggest back to 1.0
+            big = MAX(fr, MAX(fg, fb));
+
+            if (big > 65536)
             {
-                if (temperature <= 19)
-                {
-                    b = 0;
-                }
-                else
-                {
-                    b = temperature - 10;
-                    b = 138.5177312231 * log(b) - 305.0447927307;
-                    if (b < 0)
-                        b = 0;
-                    if (b > 255)
-                        b = 255;
-                }
+                fr = fr * 65536 / big;
+                fg = fg * 65536 / big;
+                fb = fb * 65536 / big;
             }
-            
+
+            set(__gamma16(fr), __gamma16(fg), __gamma16(fb));
+            return (*this);
+        }
+
+        static void fromXYBi(COLOR* dst, const uint16_t* x, const uint16_t* y, size_t n, uint8_t bright)
+        {
+            for (size_t i = 0; i < n; i++)
+                dst[i].fromXYBi(x[i], y[i], bright);
+        }
+
+        // Convert from Color Temperature
+        //
+        // Table lookup in 100 K steps (the resolution of the fit), clamped to 100 .. 40000 K
+        //
+        COLOR& fromTemperature(long kelvin)
+        {
+            const uint8_t* rgb;
+
+            kelvin = constrain(kelvin, EZ_CT_TABLE_MIN, EZ_CT_TABLE_MAX);
+            rgb = _kelvinTable[kelvin / 100 - 1];
+            set(rgb[0], rgb[1], rgb[2]);
             return (*this);
         }
 
+        static void fromTemperature(COLOR* dst, const uint16_t* kelvin, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+                dst[i].fromTemperature(kelvin[i]);
+        }
+
         // Convert to Greyscale
         //
         typedef enum class GREY_MODE
@@ -540,6 +553,36 @@ namespace EZ
             return grey;
         }
 
+        // Place the primary, secondary and tertiary of hue's 120 degree sector (0..360) in r, g
+        // and b rotated by sector, as indexed stores rather than a separate assignment per
+        // sector (the index selects may still compile to branches). Clears w.
+        //
+        void __sector(uint16_t hue, uint8_t p, uint8_t s, uint8_t t)
+        {
+            uint8_t k = hue < 120 ? 0 : (hue < 240 ? 1 : 2);
+
+            u = 0;
+            q[k] = p;
+            q[k == 2 ? 0 : k + 1] = s;
+            q[k == 0 ? 2 : k - 1] = t;
+        }
+
+        // Linear Q16 to sRGB 0..255, clamped
+        //
+        static uint8_t __gamma16(int64_t v)
+        {
+            uint32_t i, f;
+
+            if (v <= 0)
+                return 0;
+            if (v >= 65536)
+                return 255;
+
+            i = v >> 8;
+            f = v & 0xFF;
+            return (_srgbTable[i] + (((_srgbTable[i + 1] - _srgbTable[i]) * f) >> 8)) >> 8;
+        }
+
     } color_t;
 
 } // namespace EZ
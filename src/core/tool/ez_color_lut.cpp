@@ -0,0 +1,122 @@
+/*
+** EZIoT - Color Conversion Tables
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#include "ez_color_lut.h"
+
+namespace EZ
+{
+    const int16_t _hsiTable[120] = {
+        8192, 7952, 7725, 7510, 7307, 7114, 6930, 6755, 6588, 6428, 6275, 6129,
+        5988, 5852, 5721, 5595, 5474, 5356, 5242, 5132, 5024, 4920, 4819, 4721,
+        4625, 4532, 4441, 4352, 4265, 4179, 4096, 4014, 3934, 3855, 3778, 3702,
+        3627, 3554, 3481, 3410, 3339, 3269, 3201, 3133, 3065, 2998, 2932, 2867,
+        2802, 2738, 2673, 2610, 2547, 2484, 2421, 2358, 2296, 2234, 2172, 2110,
+        2048, 1986, 1924, 1862, 1800, 1738, 1675, 1612, 1549, 1486, 1423, 1358,
+        1294, 1229, 1164, 1098, 1031, 963, 895, 827, 757, 686, 615, 542,
+        469, 394, 318, 241, 162, 82, 0, -83, -169, -256, -345, -436,
+        -529, -625, -723, -824, -928, -1036, -1146, -1260, -1378, -1499, -1625, -1756,
+        -1892, -2033, -2179, -2332, -2492, -2659, -2834, -3018, -3211, -3414, -3629, -3856};
+
+    const uint16_t _srgbTable[257] = {
+        0, 3242, 5530, 7209, 8584, 9771, 10825, 11781, 12661, 13478, 14244, 14967,
+        15652, 16305, 16928, 17527, 18102, 18657, 19194, 19713, 20216, 20705, 21181, 21644,
+        22095, 22536, 22966, 23387, 23799, 24202, 24598, 24986, 25366, 25740, 26107, 26468,
+        26823, 27172, 27515, 27854, 28187, 28516, 28840, 29160, 29475, 29786, 30093, 30396,
+        30696, 30991, 31284, 31573, 31858, 32141, 32420, 32697, 32970, 33241, 33508, 33774,
+        34036, 34296, 34554, 34809, 35062, 35312, 35561, 35807, 36051, 36292, 36532, 36770,
+        37006, 37240, 37472, 37702, 37931, 38158, 38383, 38606, 38828, 39048, 39267, 39484,
+        39699, 39913, 40126, 40337, 40546, 40755, 40962, 41167, 41371, 41574, 41776, 41977,
+        42176, 42374, 42571, 42766, 42961, 43154, 43347, 43538, 43728, 43917, 44105, 44292,
+        44478, 44663, 44847, 45030, 45212, 45393, 45573, 45752, 45931, 46108, 46285, 46460,
+        46635, 46809, 46982, 47155, 47326, 47497, 47667, 47836, 48004, 48172, 48338, 48505,
+        48670, 48834, 48998, 49162, 49324, 49486, 49647, 49807, 49967, 50126, 50284, 50442,
+        50599, 50756, 50912, 51067, 51222, 51376, 51529, 51682, 51834, 51986, 52137, 52287,
+        52437, 52586, 52735, 52884, 53031, 53178, 53325, 53471, 53617, 53762, 53906, 54051,
+        54194, 54337, 54480, 54622, 54763, 54905, 55045, 55185, 55325, 55464, 55603, 55741,
+        55879, 56017, 56154, 56290, 56426, 56562, 56697, 56832, 56967, 57101, 57234, 57367,
+        57500, 57633, 57765, 57896, 58027, 58158, 58289, 58419, 58548, 58678, 58806, 58935,
+        59063, 59191, 59318, 59445, 59572, 59698, 59824, 59950, 60075, 60200, 60325, 60449,
+        60573, 60697, 60820, 60943, 61066, 61188, 61310, 61431, 61553, 61674, 61795, 61915,
+        62035, 62155, 62274, 62393, 62512, 62631, 62749, 62867, 62985, 63102, 63219, 63336,
+        63453, 63569, 63685, 63801, 63916, 64031, 64146, 64261, 64375, 64489, 64603, 64716,
+        64830, 64943, 65055, 65168, 65280};
+
+    const uint8_t _kelvinTable[400][3] = {
+        {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 17, 0},
+        {255, 32, 0}, {255, 45, 0}, {255, 57, 0}, {255, 67, 0}, {255, 77, 0}, {255, 86, 0},
+        {255, 94, 0}, {255, 101, 0}, {255, 108, 0}, {255, 114, 0}, {255, 120, 0}, {255, 126, 0},
+        {255, 131, 0}, {255, 136, 13}, {255, 141, 27}, {255, 146, 39}, {255, 150, 50}, {255, 155, 60},
+        {255, 159, 70}, {255, 162, 79}, {255, 166, 87}, {255, 170, 95}, {255, 173, 102}, {255, 177, 109},
+        {255, 180, 116}, {255, 183, 123}, {255, 186, 129}, {255, 189, 135}, {255, 192, 140}, {255, 195, 146},
+        {255, 198, 151}, {255, 200, 156}, {255, 203, 161}, {255, 205, 166}, {255, 208, 170}, {255, 210, 175},
+        {255, 213, 179}, {255, 215, 183}, {255, 217, 187}, {255, 219, 191}, {255, 221, 195}, {255, 223, 198},
+        {255, 226, 202}, {255, 228, 205}, {255, 229, 209}, {255, 231, 212}, {255, 233, 215}, {255, 235, 219},
+        {255, 237, 222}, {255, 239, 225}, {255, 241, 228}, {255, 242, 231}, {255, 244, 234}, {255, 246, 236},
+        {255, 247, 239}, {255, 249, 242}, {255, 251, 244}, {255, 252, 247}, {255, 254, 250}, {255, 255, 255},
+        {254, 248, 255}, {249, 246, 255}, {246, 244, 255}, {242, 242, 255}, {239, 240, 255}, {236, 238, 255},
+        {234, 237, 255}, {231, 236, 255}, {229, 234, 255}, {227, 233, 255}, {226, 232, 255}, {224, 231, 255},
+        {222, 230, 255}, {221, 229, 255}, {219, 228, 255}, {218, 228, 255}, {217, 227, 255}, {215, 226, 255},
+        {214, 225, 255}, {213, 225, 255}, {212, 224, 255}, {211, 224, 255}, {210, 223, 255}, {209, 222, 255},
+        {208, 222, 255}, {207, 221, 255}, {206, 221, 255}, {206, 220, 255}, {205, 220, 255}, {204, 219, 255},
+        {203, 219, 255}, {203, 218, 255}, {202, 218, 255}, {201, 218, 255}, {201, 217, 255}, {200, 217, 255},
+        {199, 216, 255}, {199, 216, 255}, {198, 216, 255}, {197, 215, 255}, {197, 215, 255}, {196, 215, 255},
+        {196, 214, 255}, {195, 214, 255}, {195, 214, 255}, {194, 213, 255}, {194, 213, 255}, {193, 213, 255},
+        {193, 212, 255}, {192, 212, 255}, {192, 212, 255}, {191, 212, 255}, {191, 211, 255}, {191, 211, 255},
+        {190, 211, 255}, {190, 210, 255}, {189, 210, 255}, {189, 210, 255}, {189, 210, 255}, {188, 209, 255},
+        {188, 209, 255}, {187, 209, 255}, {187, 209, 255}, {187, 209, 255}, {186, 208, 255}, {186, 208, 255},
+        {186, 208, 255}, {185, 208, 255}, {185, 207, 255}, {185, 207, 255}, {184, 207, 255}, {184, 207, 255},
+        {184, 207, 255}, {183, 206, 255}, {183, 206, 255}, {183, 206, 255}, {183, 206, 255}, {182, 206, 255},
+        {182, 206, 255}, {182, 205, 255}, {181, 205, 255}, {181, 205, 255}, {181, 205, 255}, {181, 205, 255},
+        {180, 204, 255}, {180, 204, 255}, {180, 204, 255}, {180, 204, 255}, {179, 204, 255}, {179, 204, 255},
+        {179, 203, 255}, {179, 203, 255}, {178, 203, 255}, {178, 203, 255}, {178, 203, 255}, {178, 203, 255},
+        {177, 203, 255}, {177, 202, 255}, {177, 202, 255}, {177, 202, 255}, {176, 202, 255}, {176, 202, 255},
+        {176, 202, 255}, {176, 202, 255}, {176, 201, 255}, {175, 201, 255}, {175, 201, 255}, {175, 201, 255},
+        {175, 201, 255}, {175, 201, 255}, {174, 201, 255}, {174, 200, 255}, {174, 200, 255}, {174, 200, 255},
+        {174, 200, 255}, {173, 200, 255}, {173, 200, 255}, {173, 200, 255}, {173, 200, 255}, {173, 199, 255},
+        {172, 199, 255}, {172, 199, 255}, {172, 199, 255}, {172, 199, 255}, {172, 199, 255}, {172, 199, 255},
+        {171, 199, 255}, {171, 199, 255}, {171, 198, 255}, {171, 198, 255}, {171, 198, 255}, {171, 198, 255},
+        {170, 198, 255}, {170, 198, 255}, {170, 198, 255}, {170, 198, 255}, {170, 198, 255}, {170, 197, 255},
+        {169, 197, 255}, {169, 197, 255}, {169, 197, 255}, {169, 197, 255}, {169, 197, 255}, {169, 197, 255},
+        {168, 197, 255}, {168, 197, 255}, {168, 197, 255}, {168, 196, 255}, {168, 196, 255}, {168, 196, 255},
+        {168, 196, 255}, {167, 196, 255}, {167, 196, 255}, {167, 196, 255}, {167, 196, 255}, {167, 196, 255},
+        {167, 196, 255}, {167, 196, 255}, {167, 195, 255}, {166, 195, 255}, {166, 195, 255}, {166, 195, 255},
+        {166, 195, 255}, {166, 195, 255}, {166, 195, 255}, {166, 195, 255}, {165, 195, 255}, {165, 195, 255},
+        {165, 195, 255}, {165, 194, 255}, {165, 194, 255}, {165, 194, 255}, {165, 194, 255}, {165, 194, 255},
+        {164, 194, 255}, {164, 194, 255}, {164, 194, 255}, {164, 194, 255}, {164, 194, 255}, {164, 194, 255},
+        {164, 194, 255}, {164, 194, 255}, {164, 193, 255}, {163, 193, 255}, {163, 193, 255}, {163, 193, 255},
+        {163, 193, 255}, {163, 193, 255}, {163, 193, 255}, {163, 193, 255}, {163, 193, 255}, {163, 193, 255},
+        {162, 193, 255}, {162, 193, 255}, {162, 193, 255}, {162, 192, 255}, {162, 192, 255}, {162, 192, 255},
+        {162, 192, 255}, {162, 192, 255}, {162, 192, 255}, {161, 192, 255}, {161, 192, 255}, {161, 192, 255},
+        {161, 192, 255}, {161, 192, 255}, {161, 192, 255}, {161, 192, 255}, {161, 192, 255}, {161, 191, 255},
+        {161, 191, 255}, {160, 191, 255}, {160, 191, 255}, {160, 191, 255}, {160, 191, 255}, {160, 191, 255},
+        {160, 191, 255}, {160, 191, 255}, {160, 191, 255}, {160, 191, 255}, {160, 191, 255}, {159, 191, 255},
+        {159, 191, 255}, {159, 191, 255}, {159, 191, 255}, {159, 190, 255}, {159, 190, 255}, {159, 190, 255},
+        {159, 190, 255}, {159, 190, 255}, {159, 190, 255}, {159, 190, 255}, {158, 190, 255}, {158, 190, 255},
+        {158, 190, 255}, {158, 190, 255}, {158, 190, 255}, {158, 190, 255}, {158, 190, 255}, {158, 190, 255},
+        {158, 190, 255}, {158, 190, 255}, {158, 189, 255}, {158, 189, 255}, {157, 189, 255}, {157, 189, 255},
+        {157, 189, 255}, {157, 189, 255}, {157, 189, 255}, {157, 189, 255}, {157, 189, 255}, {157, 189, 255},
+        {157, 189, 255}, {157, 189, 255}, {157, 189, 255}, {157, 189, 255}, {156, 189, 255}, {156, 189, 255},
+        {156, 189, 255}, {156, 189, 255}, {156, 188, 255}, {156, 188, 255}, {156, 188, 255}, {156, 188, 255},
+        {156, 188, 255}, {156, 188, 255}, {156, 188, 255}, {156, 188, 255}, {156, 188, 255}, {155, 188, 255},
+        {155, 188, 255}, {155, 188, 255}, {155, 188, 255}, {155, 188, 255}, {155, 188, 255}, {155, 188, 255},
+        {155, 188, 255}, {155, 188, 255}, {155, 188, 255}, {155, 187, 255}, {155, 187, 255}, {155, 187, 255},
+        {154, 187, 255}, {154, 187, 255}, {154, 187, 255}, {154, 187, 255}, {154, 187, 255}, {154, 187, 255},
+        {154, 187, 255}, {154, 187, 255}, {154, 187, 255}, {154, 187, 255}, {154, 187, 255}, {154, 187, 255},
+        {154, 187, 255}, {154, 187, 255}, {154, 187, 255}, {153, 187, 255}, {153, 187, 255}, {153, 187, 255},
+        {153, 186, 255}, {153, 186, 255}, {153, 186, 255}, {153, 186, 255}, {153, 186, 255}, {153, 186, 255},
+        {153, 186, 255}, {153, 186, 255}, {153, 186, 255}, {153, 186, 255}, {153, 186, 255}, {153, 186, 255},
+        {152, 186, 255}, {152, 186, 255}, {152, 186, 255}, {152, 186, 255}, {152, 186, 255}, {152, 186, 255},
+        {152, 186, 255}, {152, 186, 255}, {152, 186, 255}, {152, 186, 255}, {152, 185, 255}, {152, 185, 255},
+        {152, 185, 255}, {152, 185, 255}, {152, 185, 255}, {152, 185, 255}, {151, 185, 255}, {151, 185, 255},
+        {151, 185, 255}, {151, 185, 255}, {151, 185, 255}, {151, 185, 255}};
+} // namespace EZ
@@ -0,0 +1,40 @@
+/*
+** EZIoT - Color Conversion Tables
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_COLOR_LUT_H
+#define _EZ_COLOR_LUT_H
+#include <Arduino.h>
+
+namespace EZ
+{
+    /*
+    ** Defined once in ez_color_lut.cpp, so every unit including this shares one copy
+    */
+
+    // HSI, cos(h) / cos(60 - h) for h = 0..119 degrees, Q12
+    //
+    extern const int16_t _hsiTable[120];
+
+    // sRGB transfer function of linear 0..1 in 256 steps, 0..255 in 8.8 fixed point
+    //
+    extern const uint16_t _srgbTable[257];
+
+    // Black body RGB from 100 K to 40000 K in 100 K steps (Tanner Helland's fit)
+    //
+    static const uint16_t EZ_CT_TABLE_MIN = 100;
+    static const uint16_t EZ_CT_TABLE_MAX = 40000;
+
+    extern const uint8_t _kelvinTable[400][3];
+
+} // namespace EZ
+#endif // _EZ_COLOR_LUT_H
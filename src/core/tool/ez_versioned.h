@@ -0,0 +1,61 @@
+/*
+** EZIoT - Versioned Double Buffer
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#ifndef _EZ_VERSIONED_H
+#define _EZ_VERSIONED_H
+#include <Arduino.h>
+
+namespace EZ
+{
+    /*
+    ** Versioned double buffer, a single (mutex serialised) writer publishes into the slot
+    ** not being read, readers on either core never block. A reader only retries if a write
+    ** completed while it was copying, so it can't be held off by a preempted writer.
+    */
+    template<class _T> class VERSIONED
+    {
+    public:
+        VERSIONED() : _version(0) {}
+
+        void publish(_T value)
+        {
+            uint32_t version = _version + 1;
+
+            // The last publish's version must be visible before any of this slot's new value,
+            // or a reader still copying it (two versions back) could pass its check
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            _value[version & 1] = value;
+            __atomic_store_n(&_version, version, __ATOMIC_RELEASE);
+        }
+
+        _T read(void) const
+        {
+            uint32_t version;
+            _T value;
+
+            do
+            {
+                version = __atomic_load_n(&_version, __ATOMIC_ACQUIRE);
+                value = _value[version & 1];
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            } while (__atomic_load_n(&_version, __ATOMIC_RELAXED) != version);
+
+            return value;
+        }
+
+    private:
+        _T _value[2];
+        uint32_t _version;
+    };
+} // namespace EZ
+#endif // _EZ_VERSIONED_H
@@ -120,23 +120,6 @@ namespace EZ
                 }
             }
 
-            virtual bool ssdpMatch(String& st)
-            {
-                String _ut(upnpServiceType());
-                String _st(st);
-
-                _ut.toLowerCase();
-                _st.toLowerCase();
-
-                if (_ut.startsWith(_st))
-                {
-                    // ESP_LOGV(iotTag, "%s == %s", st.c_str(), upnpServiceType().c_str());
-                    return true;
-                }
-
-                return false;
-            }
-
             // Should these be from the _homeDevice??
             //
             virtual String upnpVersionMajor(void) { return String(_upnpVersionMajor); }
@@ -231,6 +214,8 @@ namespace EZ
 
             virtual String urlEvents(bool pathOnly = true) { return _upnpURL(pathOnly, "event"); }
 
+            virtual String urlHistory(bool pathOnly = true) { return _upnpURL(pathOnly, "history"); }
+
         protected:
             uint16_t _upnpVersionMajor;
             uint16_t _upnpVersionMinor;
@@ -285,7 +270,7 @@ namespace EZ
                 {
                     if (method == HTTP::POST && uri == urlControl(true))
                         return true;
-                    if (method == HTTP::GET && uri == urlSchema(true))
+                    if (method == HTTP::GET && (uri == urlSchema(true) || uri == urlHistory(true)))
                         return true;
                     if ((method == HTTP::SUBSCRIBE || method == HTTP::UNSUBSCRIBE) && uri == urlEvents(true))
                         return true;
@@ -313,6 +298,25 @@ namespace EZ
                     return server.send(200, MIME_TYPE_XML, upnpXML());
                 }
 
+                // history?var=name[&level=n] - see VAR::HISTORY
+                if (method == HTTP::GET && uri == urlHistory(true))
+                {
+                    ACTIVITY* activity = findActivity(server.arg("var").c_str(), ACTIVITY::MODE::VARIABLE);
+                    VAR::HISTORY* history;
+
+                    if (!activity || !(history = static_cast<VARIABLE*>(activity)->history()))
+                        return server.send(404);
+
+                    int level = server.arg("level") != "" ? server.arg("level").toInt() : -1;
+
+                    xSemaphoreTakeRecursive(mutexLock(), portMAX_DELAY);
+                    String json = history->json(level);
+                    xSemaphoreGiveRecursive(mutexLock());
+
+                    _sendCommonHeaders(server);
+                    return server.send(200, MIME_TYPE_JSON, json);
+                }
+
                 return server.send(501); // Not Implemented
             }
 
@@ -744,16 +748,10 @@ namespace EZ
 
                 if (upnpServiceType() == urn)
                 {
-                    ACTIVITY* activity = _headActivity;
+                    ACTIVITY* activity = findActivity(action.c_str(), ACTIVITY::MODE::ACTION);
 
                     if (activity)
-                    {
-                        do
-                        {
-                            if ((activity->mode() == ACTIVITY::MODE::ACTION) && activity->name() == action)
-                                return _soapAction(server, static_cast<ACTION*>(activity));
-                        } while ((activity = activity->nextActivity()));
-                    }
+                        return _soapAction(server, static_cast<ACTION*>(activity));
 
                     ESP_LOGE(iotTag, "Cannot find matching activity");
 
@@ -885,7 +883,9 @@ namespace EZ
 
                 // Prepare response/result of the action and send it on its way
                 String response("");
-                response += "<u:" + action->name() + "Response xmlns:u=\"" + upnpServiceType() + "\">\r\n";
+                response += "<u:";
+                response += action->name();
+                response += "Response xmlns:u=\"" + upnpServiceType() + "\">\r\n";
 
                 for (argc = 0; argc < EZ_UPNP_MAX_ARGS; argc++)
                 {
@@ -899,7 +899,9 @@ namespace EZ
                     }
                 }
 
-                response += "</u:" + action->name() + "Response>\r\n";
+                response += "</u:";
+                response += action->name();
+                response += "Response>\r\n";
                 return _soapEnvelope(server, 200, response);
             }
 
@@ -28,6 +28,7 @@ namespace EZ
             BOOLEAN(const char* name, bool evt, bool nvs, bool defVal = false)
                 : VARIABLE(name, "boolean", evt, nvs, sizeof(bool)), _activeValue(defVal), _defaultValue(defVal)
             {
+                _sharedValue.publish(_activeValue);
             }
 
             int validate(String& value)
@@ -37,18 +38,25 @@ namespace EZ
 
             String defaultValue(void) { return _defaultValue ? "1" : "0"; }
 
-            bool native(void) const { return _activeValue; }
-            bool native(bool nv) { return value(String(nv)); }
+            bool native(void) const { return _sharedValue.read(); }
+            bool native(bool nv)
+            {
+                return _nativeValue(_activeValue, nv, [](bool v) { return String(v ? "1" : "0"); });
+            }
 
         protected:
             bool _activeValue;
             bool _defaultValue;
+            VERSIONED<bool> _sharedValue;
+
+            void _publish(void) { _sharedValue.publish(_activeValue); }
+            String _readValue(void) { return native() ? "1" : "0"; }
 
             esp_err_t _loadValue(uint32_t nvsHandle)
             {
-                return nvs_get_u8(nvsHandle, name().c_str(), (uint8_t*)&_activeValue);
+                return nvs_get_u8(nvsHandle, name(), (uint8_t*)&_activeValue);
             }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u8(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u8(nvsHandle, name(), native()); }
 
             String _getValue(void) { return _activeValue ? "1" : "0"; }
 
@@ -30,9 +30,9 @@ namespace EZ
 
             esp_err_t _loadValue(uint32_t nvsHandle)
             {
-                return nvs_get_i8(nvsHandle, name().c_str(), (int8_t*)&_activeValue);
+                return nvs_get_i8(nvsHandle, name(), (int8_t*)&_activeValue);
             }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i8(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i8(nvsHandle, name(), native()); }
         };
 
     } // namespace VAR
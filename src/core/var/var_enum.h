@@ -62,8 +62,15 @@ namespace EZ
             }
 
         protected:
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u16(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u16(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u16(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle)
+            {
+                _takeServiceMutex();
+                uint16_t value = _activeValue;
+                _giveServiceMutex();
+
+                return nvs_set_u16(nvsHandle, name(), value);
+            }
 
             String _allowedTags(void)
             {
@@ -0,0 +1,239 @@
+/*
+** EZIoT - Variable History Classes
+**
+** Copyright (c) 2017,18 P.C.Monteith, GPL-3.0 License terms and conditions.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+*/
+#if !defined(_EZI_VAR_HISTORY_H)
+#define _EZI_VAR_HISTORY_H
+#include "../ez_variable.h"
+#include <type_traits>
+
+namespace EZ
+{
+    namespace VAR
+    {
+        /*
+        ** HISTORY - Query side of a variable's history, served by its SCP as JSON:
+        **
+        ** {"raw":[[t,v],...],"r":[{"p":period,"b":[[t,min,max,avg],...]},...]}
+        **
+        ** Times are in seconds (time()), oldest first. level < 0 returns all levels, 0 only
+        ** raw samples, 1.. only that rollup.
+        */
+        class HISTORY
+        {
+        public:
+            virtual ~HISTORY() {}
+            virtual String json(int level = -1) = 0;
+        };
+
+        template<class _T> class SERIES : public HISTORY
+        {
+        public:
+            virtual void sample(_T value) = 0;
+        };
+
+        /*
+        ** RECORDER - Fixed memory history, the last _RAW samples plus two rollups of _ROLL
+        ** buckets each (min/max/avg over period1 and period2 seconds). Attach one to a
+        ** numeric variable with var.history(recorder), every change is then recorded.
+        **
+        ** Variables are sampled on change, so a value stands until the next one: rollups
+        ** weight each value by how long it was held (into every bucket that time spans),
+        ** and min/max take in every value, however briefly held.
+        */
+        template<class _T, uint16_t _RAW, uint16_t _ROLL = 0> class RECORDER : public SERIES<_T>
+        {
+            typedef typename std::conditional<std::is_integral<_T>::value, int64_t, double>::type sum_t;
+
+            typedef struct
+            {
+                uint32_t time;
+                _T value;
+            } sample_t;
+
+            typedef struct
+            {
+                uint32_t start;
+                uint32_t seconds; // Time accounted for, sum is value x seconds
+                _T min;
+                _T max;
+                sum_t sum;
+            } bucket_t;
+
+        public:
+            RECORDER(uint32_t period1 = 60, uint32_t period2 = 3600)
+                : _rawHead(0), _rawCount(0), _held(0), _heldSince(0), _holding(false)
+            {
+                _period[0] = period1 ? period1 : 1;
+                _period[1] = period2 > _period[0] ? period2 : _period[0];
+                _rollHead[0] = _rollHead[1] = 0;
+                _rollCount[0] = _rollCount[1] = 0;
+            }
+
+            void sample(_T value)
+            {
+                uint32_t now = (uint32_t)time(nullptr);
+
+                if (_RAW)
+                {
+                    _rawHead = (_rawHead + 1) % (_RAW ? _RAW : 1);
+                    _raw[_rawHead].time = now;
+                    _raw[_rawHead].value = value;
+                    if (_rawCount < _RAW)
+                        _rawCount++;
+                }
+
+                // The old value is accounted up to now, the new one from now on
+                _hold(now);
+                _held = value;
+                _heldSince = now;
+                _holding = true;
+
+                for (int l = 0; _ROLL && l < 2; l++)
+                {
+                    bucket_t* bucket = _bucket(l, now - (now % _period[l]));
+
+                    if (value < bucket->min)
+                        bucket->min = value;
+                    if (value > bucket->max)
+                        bucket->max = value;
+                }
+            }
+
+            String json(int level = -1)
+            {
+                String json("{");
+
+                // Bring the rollups up to date with the value still being held
+                _hold((uint32_t)time(nullptr));
+
+                if (level <= 0)
+                {
+                    json.concat("\"raw\":[");
+                    for (uint16_t i = 0; i < _rawCount; i++)
+                    {
+                        sample_t* s = &_raw[(_rawHead + _RAW - _rawCount + 1 + i) % (_RAW ? _RAW : 1)];
+
+                        if (i)
+                            json.concat(",");
+                        json.concat("[" + String(s->time) + "," + String(s->value) + "]");
+                    }
+                    json.concat("]");
+                }
+
+                if (level != 0 && _ROLL)
+                {
+                    json.concat(level < 0 ? ",\"r\":[" : "\"r\":[");
+
+                    for (int l = 0; l < 2; l++)
+                    {
+                        if (level > 0 && level != l + 1)
+                            continue;
+
+                        if (level < 0 && l)
+                            json.concat(",");
+                        json.concat("{\"p\":" + String(_period[l]) + ",\"b\":[");
+
+                        for (uint16_t i = 0; i < _rollCount[l]; i++)
+                        {
+                            bucket_t* b = &_roll[l][(_rollHead[l] + _ROLL - _rollCount[l] + 1 + i) % (_ROLL ? _ROLL : 1)];
+
+                            if (i)
+                                json.concat(",");
+                            json.concat("[" + String(b->start) + "," + String(b->min) + "," + String(b->max) + "," +
+                                        String(b->seconds ? (float)b->sum / b->seconds : (float)_held, 2) + "]");
+                        }
+                        json.concat("]}");
+                    }
+                    json.concat("]");
+                }
+
+                json.concat("}");
+                return json;
+            }
+
+        private:
+            sample_t _raw[_RAW ? _RAW : 1];
+            bucket_t _roll[2][_ROLL ? _ROLL : 1];
+            uint32_t _period[2];
+            uint16_t _rawHead;
+            uint16_t _rawCount;
+            uint16_t _rollHead[2];
+            uint16_t _rollCount[2];
+            _T _held;            // Current value, held since _heldSince
+            uint32_t _heldSince; // and accounted for up to then
+            bool _holding;
+
+            // The bucket starting at start, opening it (seeded with the held value) if it's
+            // not the newest
+            bucket_t* _bucket(int l, uint32_t start)
+            {
+                bucket_t* bucket = &_roll[l][_rollHead[l]];
+
+                if (!_rollCount[l] || bucket->start != start)
+                {
+                    if (_rollCount[l])
+                        _rollHead[l] = (_rollHead[l] + 1) % (_ROLL ? _ROLL : 1);
+                    if (_rollCount[l] < _ROLL)
+                        _rollCount[l]++;
+
+                    bucket = &_roll[l][_rollHead[l]];
+                    bucket->start = start;
+                    bucket->seconds = 0;
+                    bucket->min = bucket->max = _held;
+                    bucket->sum = 0;
+                }
+
+                return bucket;
+            }
+
+            // Accounts for the held value from _heldSince up to now, across as many buckets as
+            // that spans (at most the last _ROLL, any before them would be overwritten)
+            void _hold(uint32_t now)
+            {
+                if (!_holding || (int32_t)(now - _heldSince) <= 0)
+                {
+                    _heldSince = now; // Also when the clock has been set back
+                    return;
+                }
+
+                for (int l = 0; _ROLL && l < 2; l++)
+                {
+                    uint32_t period = _period[l];
+                    uint32_t from = _heldSince;
+                    uint32_t oldest = now - (now % period) - (uint32_t)(_ROLL - 1) * period;
+
+                    if ((now - from) / period >= _ROLL && (int32_t)(oldest - from) > 0)
+                        from = oldest;
+
+                    while (from < now)
+                    {
+                        uint32_t start = from - (from % period);
+                        uint32_t until = (now - start) > period ? start + period : now;
+                        bucket_t* bucket = _bucket(l, start);
+
+                        if (_held < bucket->min)
+                            bucket->min = _held;
+                        if (_held > bucket->max)
+                            bucket->max = _held;
+                        bucket->sum += (sum_t)_held * (until - from);
+                        bucket->seconds += until - from;
+                        from = until;
+                    }
+                }
+
+                _heldSince = now;
+            }
+        };
+    } // namespace VAR
+} // namespace EZ
+#endif //_EZI_VAR_HISTORY_H
@@ -26,9 +26,11 @@ namespace EZ
         public:
             virtual ~NUMERIC() {}
             NUMERIC(const char* name, const char* type, bool evt, bool nvs, _T defVal, _T minVal, _T maxVal, _T stepVal)
-                : VARIABLE(name, type, evt, nvs, sizeof(_T)), _minValue(minVal), _maxValue(maxVal), _stepValue(stepVal)
+                : VARIABLE(name, type, evt, nvs, sizeof(_T)), _minValue(minVal), _maxValue(maxVal), _stepValue(stepVal),
+                  _series(nullptr)
             {
                 _activeValue = _defaultValue = defVal;
+                _sharedValue.publish(_activeValue);
             }
 
             String defaultValue(void) { return _toString(_defaultValue); }
@@ -39,6 +41,11 @@ namespace EZ
 
                 _deString(value, nv);
 
+                return validate(nv);
+            }
+
+            int validate(_T nv)
+            {
                 // Value must be in range?
                 if (nv < _minValue || nv > _maxValue)
                     return EZ_SOAP_ERROR_OUT_OF_RANGE;
@@ -50,8 +57,18 @@ namespace EZ
                 return EZ_SOAP_ERROR_NONE;
             }
 
-            _T native(void) const { return _activeValue; }
-            bool native(_T nv) { return value(String(nv)); }
+            _T native(void) const { return _sharedValue.read(); }
+
+            HISTORY* history(void) { return _series; }
+            void history(SERIES<_T>& series)
+            {
+                _series = &series;
+                _series->sample(native());
+            }
+            bool native(_T nv)
+            {
+                return _checkValue(nv) && _nativeValue(_activeValue, nv, [this](_T v) { return _toString(v); });
+            }
 
         protected:
             _T _activeValue;
@@ -59,6 +76,16 @@ namespace EZ
             _T _minValue;
             _T _maxValue;
             _T _stepValue;
+            VERSIONED<_T> _sharedValue;
+            SERIES<_T>* _series;
+
+            void _publish(void)
+            {
+                _sharedValue.publish(_activeValue);
+                if (_series)
+                    _series->sample(_activeValue);
+            }
+            String _readValue(void) { return _toString(native()); }
 
             String _allowedTags(void)
             {
@@ -84,6 +111,21 @@ namespace EZ
 
                 _deString(newValue, nv);
 
+                if (!_checkValue(nv))
+                    return false;
+
+                // Changed? - set new value and advise
+                if (_activeValue != nv)
+                {
+                    _activeValue = nv;
+                    return true;
+                }
+
+                return false;
+            }
+
+            bool _checkValue(_T& nv)
+            {
                 // Value must be in range?
                 if (_minValue != _maxValue)
                 {
@@ -97,14 +139,7 @@ namespace EZ
                 if ((_stepValue != 0) && (nv % _stepValue) != 0)
                     return false;
 
-                // Changed? - set new value and advise
-                if (_activeValue != nv)
-                {
-                    _activeValue = nv;
-                    return true;
-                }
-
-                return false;
+                return true;
             }
 
         private:
@@ -147,8 +182,8 @@ namespace EZ
             {
             }
 
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u8(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u8(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u8(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u8(nvsHandle, name(), native()); }
         };
 
         /*
@@ -163,8 +198,8 @@ namespace EZ
             {
             }
 
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u16(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u16(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u16(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u16(nvsHandle, name(), native()); }
         };
 
         /*
@@ -179,8 +214,8 @@ namespace EZ
             {
             }
 
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u32(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u32(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u32(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u32(nvsHandle, name(), native()); }
         };
 
         /*
@@ -195,8 +230,8 @@ namespace EZ
             {
             }
 
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u64(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u64(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_u64(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_u64(nvsHandle, name(), native()); }
         };
 
         /*
@@ -211,8 +246,8 @@ namespace EZ
             {
             }
 
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i8(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i8(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i8(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i8(nvsHandle, name(), native()); }
         };
 
         /*
@@ -227,8 +262,8 @@ namespace EZ
             {
             }
 
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i16(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i16(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i16(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i16(nvsHandle, name(), native()); }
         };
 
         /*
@@ -244,8 +279,8 @@ namespace EZ
             {
             }
 
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i32(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i32(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i32(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i32(nvsHandle, name(), native()); }
         };
 
         /*
@@ -261,8 +296,8 @@ namespace EZ
             {
             }
 
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i64(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i64(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i64(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i64(nvsHandle, name(), native()); }
         };
 
         /*
@@ -277,8 +312,8 @@ namespace EZ
             {
             }
 
-            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i32(nvsHandle, name().c_str(), &_activeValue); }
-            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i32(nvsHandle, name().c_str(), _activeValue); }
+            esp_err_t _loadValue(uint32_t nvsHandle) { return nvs_get_i32(nvsHandle, name(), &_activeValue); }
+            esp_err_t _saveValue(uint32_t nvsHandle) { return nvs_set_i32(nvsHandle, name(), native()); }
         };
 
         // TODO: r4, r8, number(=r8), fixed.14.4 and float
@@ -58,7 +58,7 @@ namespace EZ
             esp_err_t _loadValue(uint32_t nvsHandle)
             {
                 size_t len = 0;
-                esp_err_t err = nvs_get_str(nvsHandle, name().c_str(), NULL, &len);
+                esp_err_t err = nvs_get_str(nvsHandle, name(), NULL, &len);
 
                 if (!err)
                 {
@@ -68,7 +68,7 @@ namespace EZ
                         {
                             char value[len];
                             len = _size;
-                            err = nvs_get_str(nvsHandle, name().c_str(), value, &len);
+                            err = nvs_get_str(nvsHandle, name(), value, &len);
 
                             if (!err)
                             {
@@ -87,7 +87,11 @@ namespace EZ
 
             esp_err_t _saveValue(uint32_t nvsHandle)
             {
-                return nvs_set_str(nvsHandle, name().c_str(), _activeValue.c_str());
+                _takeServiceMutex();
+                String value(_activeValue);
+                _giveServiceMutex();
+
+                return nvs_set_str(nvsHandle, name(), value.c_str());
             }
 
         private:
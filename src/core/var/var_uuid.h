@@ -71,12 +71,12 @@ namespace EZ
             {
                 size_t len = 0;
 
-                esp_err_t err = nvs_get_blob(nvsHandle, name().c_str(), NULL, &len);
+                esp_err_t err = nvs_get_blob(nvsHandle, name(), NULL, &len);
 
                 if (!err)
                 {
                     if (len == _activeValue.size())
-                        return nvs_get_blob(nvsHandle, name().c_str(), _activeValue.raw_address(), &len);
+                        return nvs_get_blob(nvsHandle, name(), _activeValue.raw_address(), &len);
                     err = ESP_ERR_NVS_TYPE_MISMATCH;
                 }
 
@@ -85,7 +85,13 @@ namespace EZ
 
             esp_err_t _saveValue(uint32_t nvsHandle)
             {
-                return nvs_set_blob(nvsHandle, name().c_str(), _activeValue.raw_address(), _activeValue.size());
+                uint8_t value[16];
+
+                _takeServiceMutex();
+                memcpy(value, _activeValue.raw_address(), sizeof(value));
+                _giveServiceMutex();
+
+                return nvs_set_blob(nvsHandle, name(), value, sizeof(value));
             }
 
             String _getValue(void) { return _activeValue.toString(); }
@@ -17,6 +17,8 @@
 #include "core/iot.h"
 #include "core/hal/hal_dmx.h"
 #include "core/hal/hal_neo.h"
+#include "core/hal/hal_neo_i2s.h"
+#include "core/hal/hal_neo_scheduler.h"
 
 #endif // _EZ_H
 #else  // ARDUINO_ARCH_ESP32